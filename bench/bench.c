@@ -0,0 +1,623 @@
+// Headless benchmark for physx_lib. Every scenario builds the same scene from fixed parameters, so runs are
+// comparable between commits. Build with build.sh, run with the names of the scenarios to run (all by default):
+//   bench/bench [--threads N] [--scale S] [--track] [--pool] [box_stacks pile ragdolls ray_storm controllers cooking api]
+#define _POSIX_C_SOURCE 200809L
+#include "../physx_lib.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Allocator that tracks live bytes, the high-water mark and the number of allocations
+typedef struct Alloc_Stats {
+	atomic_size_t current;
+	atomic_size_t peak;
+	atomic_size_t count;
+} Alloc_Stats;
+
+#define ALLOC_HEADER 16
+
+static void* tracking_allocate(Px_Allocator* allocator, size_t size, char const* filename, int line) {
+	(void) filename;
+	(void) line;
+	Alloc_Stats* stats = (Alloc_Stats*) allocator->user_data;
+	size_t total = (size + ALLOC_HEADER + 15) & ~(size_t) 15;
+	void* block = aligned_alloc(16, total);
+	if(!block) {
+		return NULL;
+	}
+	*(size_t*) block = size;
+
+	size_t current = atomic_fetch_add(&stats->current, size) + size;
+	size_t peak = atomic_load(&stats->peak);
+	while(current > peak && !atomic_compare_exchange_weak(&stats->peak, &peak, current)) {}
+	atomic_fetch_add(&stats->count, 1);
+	return (char*) block + ALLOC_HEADER;
+}
+
+static void tracking_deallocate(Px_Allocator* allocator, void* ptr) {
+	Alloc_Stats* stats = (Alloc_Stats*) allocator->user_data;
+	if(!ptr) {
+		return;
+	}
+	void* block = (char*) ptr - ALLOC_HEADER;
+	atomic_fetch_sub(&stats->current, *(size_t*) block);
+	free(block);
+}
+
+static Alloc_Stats gStats;
+static float gScale = 1.0f;
+static uint32_t gThreads = 4;
+static bool gTrack = false;
+
+static double now_ms(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+static uint32_t scaled(uint32_t count) {
+	uint32_t result = (uint32_t) (count * gScale);
+	return result ? result : 1;
+}
+
+// Deterministic pseudo random numbers in [0, 1)
+static uint32_t gRandom = 1;
+static float random_float(void) {
+	gRandom = gRandom * 1664525u + 1013904223u;
+	return (gRandom >> 8) / 16777216.0f;
+}
+
+static Px_Vector3f32 vec3(float x, float y, float z) {
+	Px_Vector3f32 v = {x, y, z};
+	return v;
+}
+
+static Px_Transform transform_at(float x, float y, float z) {
+	Px_Transform t = {{0, 0, 0, 1}, {x, y, z}};
+	return t;
+}
+
+static void begin_scenario(void) {
+	atomic_store(&gStats.peak, atomic_load(&gStats.current));
+	atomic_store(&gStats.count, 0);
+	gRandom = 1;
+}
+
+static void report(char const* scenario, char const* metric, double value, char const* unit) {
+	printf("%-12s %-28s %14.3f %s\n", scenario, metric, value, unit);
+}
+
+static void report_memory(char const* scenario) {
+	report(scenario, "memory high-water", atomic_load(&gStats.peak) / (1024.0 * 1024.0), "MB");
+	report(scenario, "allocations", (double) atomic_load(&gStats.count), "");
+}
+
+static Px_Scene create_scene(void) {
+	Px_Scene_Settings settings = {0};
+	Px_Scene scene = px_scene_create(settings);
+	px_scene_set_gravity(scene, vec3(0, -9.81f, 0));
+	return scene;
+}
+
+static Px_Actor create_ground(Px_Scene scene, Px_Material material, float half_size) {
+	Px_Shape_Description shape = {0};
+	shape.type = eSHAPE_BOX;
+	shape.half_extents = vec3(half_size, 1, half_size);
+	shape.material = material;
+	Px_Actor ground = px_actor_create_static(transform_at(0, -1, 0), &shape, 1);
+	px_scene_add_actor(scene, ground);
+	return ground;
+}
+
+#define SCRATCH_SIZE (16 * 1024 * 1024)
+static void* gScratch;
+
+// Steps the scene and reports steps/sec and the scene's own timing breakdown of the last step
+static void run_steps(char const* scenario, Px_Scene scene, uint32_t num_steps) {
+	double start = now_ms();
+	for(uint32_t i = 0; i < num_steps; ++i) {
+		px_allocator_begin_frame();
+		px_scene_simulate(scene, 1.0f / 60.0f, gScratch, SCRATCH_SIZE);
+	}
+	double elapsed = now_ms() - start;
+	report(scenario, "steps/sec", num_steps / (elapsed / 1000.0), "");
+	if(gTrack) {
+		report(scenario, "last step physx allocations", (double) px_allocator_get_stats().frame_count, "");
+	}
+	report(scenario, "ms/step", elapsed / num_steps, "ms");
+
+	Px_Scene_Stats stats = px_scene_get_stats(scene);
+	report(scenario, "last step fetch_results", stats.fetch_results_ms, "ms");
+	report(scenario, "active bodies", stats.num_active_dynamic_bodies, "");
+	report(scenario, "contact pairs", stats.num_discrete_contact_pairs_with_contacts, "");
+}
+
+static void release_actors(Px_Actor* actors, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i) {
+		px_actor_release(actors[i]);
+	}
+}
+
+static void bench_box_stacks(Px_Material material) {
+	char const* name = "box_stacks";
+	begin_scenario();
+	Px_Scene scene = create_scene();
+	Px_Actor ground = create_ground(scene, material, 200);
+
+	uint32_t num_stacks = scaled(100);
+	uint32_t height = 10;
+	uint32_t count = num_stacks * height;
+	Px_Shape_Description shape = {0};
+	shape.type = eSHAPE_BOX;
+	shape.half_extents = vec3(0.5f, 0.5f, 0.5f);
+	shape.material = material;
+
+	Px_Actor_Description* descriptions = calloc(count, sizeof(Px_Actor_Description));
+	Px_Actor* actors = calloc(count, sizeof(Px_Actor));
+	uint32_t side = (uint32_t) ceilf(sqrtf((float) num_stacks));
+	for(uint32_t i = 0; i < count; ++i) {
+		uint32_t stack = i / height;
+		descriptions[i].type = eACTOR_DYNAMIC;
+		descriptions[i].transform = transform_at((stack % side) * 3.0f, 0.5f + (i % height) * 1.0f, (stack / side) * 3.0f);
+		descriptions[i].shapes = &shape;
+		descriptions[i].num_shapes = 1;
+	}
+
+	double start = now_ms();
+	px_actors_create_batch(descriptions, count, actors);
+	px_scene_add_actors(scene, actors, count);
+	report(name, "ns/actor create+add", (now_ms() - start) * 1e6 / count, "ns");
+
+	run_steps(name, scene, 300);
+	report_memory(name);
+
+	release_actors(actors, count);
+	px_actor_release(ground);
+	px_scene_release(scene);
+	free(actors);
+	free(descriptions);
+}
+
+static void bench_pile(Px_Material material) {
+	char const* name = "pile";
+	begin_scenario();
+	Px_Scene scene = create_scene();
+	Px_Actor ground = create_ground(scene, material, 500);
+
+	uint32_t count = scaled(50000);
+	Px_Shape_Description shapes[2] = {{0}, {0}};
+	shapes[0].type = eSHAPE_BOX;
+	shapes[0].half_extents = vec3(0.4f, 0.4f, 0.4f);
+	shapes[0].material = material;
+	shapes[1].type = eSHAPE_SPHERE;
+	shapes[1].radius = 0.4f;
+	shapes[1].material = material;
+
+	Px_Actor_Description* descriptions = calloc(count, sizeof(Px_Actor_Description));
+	Px_Actor* actors = calloc(count, sizeof(Px_Actor));
+	uint32_t side = 50;
+	for(uint32_t i = 0; i < count; ++i) {
+		uint32_t layer = i / (side * side);
+		uint32_t index = i % (side * side);
+		descriptions[i].type = eACTOR_DYNAMIC;
+		descriptions[i].transform = transform_at((index % side) * 1.0f - side * 0.5f + random_float() * 0.1f, 1.0f + layer * 1.0f, (index / side) * 1.0f - side * 0.5f);
+		descriptions[i].shapes = &shapes[i & 1];
+		descriptions[i].num_shapes = 1;
+	}
+
+	double start = now_ms();
+	px_actors_create_batch(descriptions, count, actors);
+	px_scene_add_actors(scene, actors, count);
+	report(name, "ns/actor create+add", (now_ms() - start) * 1e6 / count, "ns");
+
+	run_steps(name, scene, 120);
+
+	Px_Vector3f32* positions = malloc(sizeof(Px_Vector3f32) * count);
+	Px_Quaternionf32* rotations = malloc(sizeof(Px_Quaternionf32) * count);
+	start = now_ms();
+	uint32_t num_active = px_scene_read_active_transforms(scene, NULL, positions, rotations, NULL, NULL, NULL, count);
+	if(num_active) {
+		report(name, "ns/active transform read", (now_ms() - start) * 1e6 / num_active, "ns");
+	}
+	report_memory(name);
+
+	free(rotations);
+	free(positions);
+	release_actors(actors, count);
+	px_actor_release(ground);
+	px_scene_release(scene);
+	free(actors);
+	free(descriptions);
+}
+
+// No joints in the wrapper, so ragdolls are approximated by compounds of limb shapes around a torso
+static void bench_ragdolls(Px_Material material) {
+	char const* name = "ragdolls";
+	begin_scenario();
+	Px_Scene scene = create_scene();
+	Px_Actor ground = create_ground(scene, material, 200);
+
+	#define NUM_LIMBS 11
+	Px_Shape_Description limbs[NUM_LIMBS];
+	memset(limbs, 0, sizeof(limbs));
+	Px_Vector3f32 offsets[NUM_LIMBS] = {
+		{0, 0, 0}, {0, 0.5f, 0}, {0, 0.95f, 0}, // pelvis, chest, head
+		{-0.45f, 0.55f, 0}, {-0.85f, 0.55f, 0}, {0.45f, 0.55f, 0}, {0.85f, 0.55f, 0}, // arms
+		{-0.2f, -0.5f, 0}, {-0.2f, -0.95f, 0}, {0.2f, -0.5f, 0}, {0.2f, -0.95f, 0}, // legs
+	};
+	for(uint32_t i = 0; i < NUM_LIMBS; ++i) {
+		limbs[i].type = i == 2 ? eSHAPE_SPHERE : eSHAPE_BOX;
+		limbs[i].radius = 0.15f;
+		limbs[i].half_extents = i < 3 ? vec3(0.25f, 0.2f, 0.15f) : vec3(0.18f, 0.08f, 0.08f);
+		if(i >= 7) {
+			limbs[i].half_extents = vec3(0.08f, 0.2f, 0.08f);
+		}
+		limbs[i].local_pose = transform_at(offsets[i].x, offsets[i].y, offsets[i].z);
+		limbs[i].material = material;
+	}
+
+	uint32_t count = scaled(2000);
+	Px_Actor_Description* descriptions = calloc(count, sizeof(Px_Actor_Description));
+	Px_Actor* actors = calloc(count, sizeof(Px_Actor));
+	uint32_t side = 40;
+	for(uint32_t i = 0; i < count; ++i) {
+		descriptions[i].type = eACTOR_DYNAMIC;
+		descriptions[i].transform = transform_at((i % side) * 2.5f - side * 1.25f, 2.0f + (i / (side * side)) * 3.0f, ((i / side) % side) * 2.5f - side * 1.25f);
+		descriptions[i].shapes = limbs;
+		descriptions[i].num_shapes = NUM_LIMBS;
+	}
+
+	double start = now_ms();
+	px_actors_create_batch(descriptions, count, actors);
+	px_scene_add_actors(scene, actors, count);
+	report(name, "ns/compound create+add", (now_ms() - start) * 1e6 / count, "ns");
+
+	run_steps(name, scene, 200);
+	report_memory(name);
+
+	release_actors(actors, count);
+	px_actor_release(ground);
+	px_scene_release(scene);
+	free(actors);
+	free(descriptions);
+}
+
+static void bench_ray_storm(Px_Material material) {
+	char const* name = "ray_storm";
+	begin_scenario();
+	Px_Scene scene = create_scene();
+	Px_Actor ground = create_ground(scene, material, 200);
+
+	uint32_t num_targets = scaled(10000);
+	Px_Shape_Description shape = {0};
+	shape.type = eSHAPE_BOX;
+	shape.half_extents = vec3(0.5f, 0.5f, 0.5f);
+	shape.material = material;
+	Px_Actor_Description* descriptions = calloc(num_targets, sizeof(Px_Actor_Description));
+	Px_Actor* targets = calloc(num_targets, sizeof(Px_Actor));
+	for(uint32_t i = 0; i < num_targets; ++i) {
+		descriptions[i].type = eACTOR_STATIC;
+		descriptions[i].transform = transform_at(random_float() * 300 - 150, random_float() * 20, random_float() * 300 - 150);
+		descriptions[i].shapes = &shape;
+		descriptions[i].num_shapes = 1;
+	}
+	px_actors_create_batch(descriptions, num_targets, targets);
+	px_scene_add_actors(scene, targets, num_targets);
+	// Builds the query structures
+	px_scene_simulate(scene, 1.0f / 60.0f, gScratch, SCRATCH_SIZE);
+
+	uint32_t count = scaled(100000);
+	Px_Vector3f32* origins = malloc(sizeof(Px_Vector3f32) * count);
+	Px_Vector3f32* directions = malloc(sizeof(Px_Vector3f32) * count);
+	float* distances = malloc(sizeof(float) * count);
+	uint32_t* mask_indices = calloc(count, sizeof(uint32_t));
+	Px_Query_Batch_Hit* hits = malloc(sizeof(Px_Query_Batch_Hit) * count);
+	for(uint32_t i = 0; i < count; ++i) {
+		origins[i] = vec3(random_float() * 300 - 150, 10, random_float() * 300 - 150);
+		float x = random_float() * 2 - 1, y = random_float() * 2 - 1, z = random_float() * 2 - 1;
+		float length = sqrtf(x * x + y * y + z * z) + 1e-6f;
+		directions[i] = vec3(x / length, y / length, z / length);
+		distances[i] = 100;
+	}
+
+	double start = now_ms();
+	px_scene_raycast_batch(scene, origins, directions, distances, mask_indices, count, hits);
+	double elapsed = now_ms() - start;
+	uint32_t num_hits = 0;
+	for(uint32_t i = 0; i < count; ++i) {
+		num_hits += hits[i].actor != NULL;
+	}
+	report(name, "batch rays/sec", count / (elapsed / 1000.0), "");
+	report(name, "batch ns/ray", elapsed * 1e6 / count, "ns");
+	report(name, "batch hit ratio", (double) num_hits / count, "");
+
+	uint32_t num_single = count / 10 ? count / 10 : 1;
+	start = now_ms();
+	for(uint32_t i = 0; i < num_single; ++i) {
+		px_scene_raycast(scene, origins[i], directions[i], distances[i], 0);
+	}
+	report(name, "single ns/ray", (now_ms() - start) * 1e6 / num_single, "ns");
+	report_memory(name);
+
+	free(hits);
+	free(mask_indices);
+	free(distances);
+	free(directions);
+	free(origins);
+	release_actors(targets, num_targets);
+	px_actor_release(ground);
+	px_scene_release(scene);
+	free(targets);
+	free(descriptions);
+}
+
+static void bench_controllers(Px_Material material) {
+	char const* name = "controllers";
+	begin_scenario();
+	Px_Scene scene = create_scene();
+	Px_Actor ground = create_ground(scene, material, 200);
+
+	uint32_t count = scaled(1000);
+	Px_Controller* controllers = malloc(sizeof(Px_Controller) * count);
+	Px_Controller_Settings settings = {0};
+	settings.slope_limit_deg = 45;
+	settings.height = 1.2f;
+	settings.radius = 0.3f;
+	settings.up = vec3(0, 1, 0);
+	settings.material = material;
+	uint32_t side = 40;
+	for(uint32_t i = 0; i < count; ++i) {
+		controllers[i] = px_controller_create(scene, settings);
+		px_controller_set_position(controllers[i], vec3((i % side) * 1.5f - side * 0.75f, 1.0f, (i / side) * 1.5f - side * 0.75f));
+	}
+
+	// One third of the frames each: a call per controller, a serial batch and a parallel batch
+	uint32_t num_frames = 120;
+	double move_ms[3] = {0, 0, 0};
+	Px_Vector3f32* displacements = malloc(sizeof(Px_Vector3f32) * count);
+	uint32_t* mask_indices = calloc(count, sizeof(uint32_t));
+	uint8_t* flags = malloc(count);
+	Px_Vector3f32* positions = malloc(sizeof(Px_Vector3f32) * count);
+	double start = now_ms();
+	for(uint32_t frame = 0; frame < num_frames; ++frame) {
+		for(uint32_t i = 0; i < count; ++i) {
+			float angle = (float) (i * 0.37f + frame * 0.05f);
+			displacements[i] = vec3(cosf(angle) * 0.05f, -0.1f, sinf(angle) * 0.05f);
+		}
+		uint32_t mode = frame * 3 / num_frames;
+		double move_start = now_ms();
+		if(mode == 0) {
+			for(uint32_t i = 0; i < count; ++i) {
+				px_controller_move(controllers[i], displacements[i], 1.0f / 60.0f, 0);
+			}
+		}
+		else {
+			px_controllers_move_batch(controllers, displacements, mask_indices, count, 1.0f / 60.0f, mode == 2 ? 4.0f : 0.0f, flags, positions);
+		}
+		move_ms[mode] += now_ms() - move_start;
+		px_scene_simulate(scene, 1.0f / 60.0f, gScratch, SCRATCH_SIZE);
+	}
+	double elapsed = now_ms() - start;
+	double moves_per_mode = (double) num_frames / 3 * count;
+	report(name, "frames/sec", num_frames / (elapsed / 1000.0), "");
+	report(name, "ns/controller move", move_ms[0] * 1e6 / moves_per_mode, "ns");
+	report(name, "ns/controller batch serial", move_ms[1] * 1e6 / moves_per_mode, "ns");
+	report(name, "ns/controller batch parallel", move_ms[2] * 1e6 / moves_per_mode, "ns");
+	free(positions);
+	free(flags);
+	free(mask_indices);
+	free(displacements);
+	report_memory(name);
+
+	for(uint32_t i = 0; i < count; ++i) {
+		px_controller_release(controllers[i]);
+	}
+	free(controllers);
+	px_actor_release(ground);
+	px_scene_release(scene);
+}
+
+static void bench_cooking(void) {
+	char const* name = "cooking";
+	begin_scenario();
+
+	// Height field like grid
+	uint32_t side = scaled(256) + 1;
+	uint32_t num_vertices = side * side;
+	uint32_t num_triangles = (side - 1) * (side - 1) * 2;
+	Px_Vector3f32* vertices = malloc(sizeof(Px_Vector3f32) * num_vertices);
+	uint32_t* indices = malloc(sizeof(uint32_t) * 3 * num_triangles);
+	for(uint32_t i = 0; i < num_vertices; ++i) {
+		float x = (float) (i % side), z = (float) (i / side);
+		vertices[i] = vec3(x, sinf(x * 0.1f) * cosf(z * 0.1f) * 3.0f, z);
+	}
+	uint32_t* index = indices;
+	for(uint32_t z = 0; z + 1 < side; ++z) {
+		for(uint32_t x = 0; x + 1 < side; ++x) {
+			uint32_t v = z * side + x;
+			*index++ = v; *index++ = v + side; *index++ = v + 1;
+			*index++ = v + 1; *index++ = v + side; *index++ = v + side + 1;
+		}
+	}
+	Px_Mesh_Description grid = {0};
+	grid.vertices = vertices;
+	grid.num_vertices = num_vertices;
+	grid.vertex_stride = sizeof(Px_Vector3f32);
+	grid.indices = indices;
+	grid.num_triangles = num_triangles;
+	grid.triangle_stride = sizeof(uint32_t) * 3;
+
+	Px_Cooking_Options options = {0};
+	double start = now_ms();
+	Px_Buffer buffer = px_cook_triangle_mesh(grid, options);
+	double elapsed = now_ms() - start;
+	report(name, "triangle mesh ms", elapsed, "ms");
+	report(name, "triangle mesh ns/triangle", elapsed * 1e6 / num_triangles, "ns");
+	px_buffer_free(buffer);
+
+	// Point clouds on a sphere
+	#define NUM_HULL_POINTS 256
+	uint32_t num_hulls = scaled(64);
+	Px_Vector3f32* points = malloc(sizeof(Px_Vector3f32) * NUM_HULL_POINTS * num_hulls);
+	Px_Mesh_Description* hulls = calloc(num_hulls, sizeof(Px_Mesh_Description));
+	Px_Buffer* buffers = calloc(num_hulls, sizeof(Px_Buffer));
+	for(uint32_t i = 0; i < NUM_HULL_POINTS * num_hulls; ++i) {
+		float theta = random_float() * 6.2831853f, z = random_float() * 2 - 1;
+		float r = sqrtf(1 - z * z);
+		points[i] = vec3(r * cosf(theta), r * sinf(theta), z);
+	}
+	for(uint32_t i = 0; i < num_hulls; ++i) {
+		hulls[i].vertices = points + i * NUM_HULL_POINTS;
+		hulls[i].num_vertices = NUM_HULL_POINTS;
+		hulls[i].vertex_stride = sizeof(Px_Vector3f32);
+	}
+
+	start = now_ms();
+	buffer = px_cook_convex_mesh(hulls[0], options);
+	report(name, "convex mesh ms", now_ms() - start, "ms");
+	px_buffer_free(buffer);
+
+	start = now_ms();
+	px_cook_convex_meshes(hulls, num_hulls, options, buffers);
+	report(name, "convex batch ms/mesh", (now_ms() - start) / num_hulls, "ms");
+	for(uint32_t i = 0; i < num_hulls; ++i) {
+		px_buffer_free(buffers[i]);
+	}
+	report_memory(name);
+
+	free(buffers);
+	free(hulls);
+	free(points);
+	free(indices);
+	free(vertices);
+}
+
+// Per call overhead of the wrapper's small functions
+static void bench_api(Px_Material material) {
+	char const* name = "api";
+	begin_scenario();
+	Px_Scene scene = create_scene();
+
+	uint32_t count = scaled(10000);
+	Px_Shape_Description shape = {0};
+	shape.type = eSHAPE_SPHERE;
+	shape.radius = 0.5f;
+	shape.material = material;
+	Px_Actor_Description* descriptions = calloc(count, sizeof(Px_Actor_Description));
+	Px_Actor* actors = calloc(count, sizeof(Px_Actor));
+	Px_Transform* transforms = malloc(sizeof(Px_Transform) * count);
+	for(uint32_t i = 0; i < count; ++i) {
+		descriptions[i].type = eACTOR_DYNAMIC;
+		descriptions[i].transform = transform_at((float) (i % 100) * 2, 10, (float) (i / 100) * 2);
+		descriptions[i].shapes = &shape;
+		descriptions[i].num_shapes = 1;
+	}
+	px_actors_create_batch(descriptions, count, actors);
+	px_scene_add_actors(scene, actors, count);
+
+	double start = now_ms();
+	for(uint32_t i = 0; i < count; ++i) {
+		transforms[i] = px_actor_get_transform(actors[i]);
+	}
+	report(name, "ns/actor_get_transform", (now_ms() - start) * 1e6 / count, "ns");
+
+	start = now_ms();
+	for(uint32_t i = 0; i < count; ++i) {
+		px_actor_set_transform(actors[i], transforms[i], true);
+	}
+	report(name, "ns/actor_set_transform", (now_ms() - start) * 1e6 / count, "ns");
+
+	start = now_ms();
+	px_actors_set_transforms(actors, transforms, 0, count);
+	report(name, "ns/actors_set_transforms", (now_ms() - start) * 1e6 / count, "ns");
+
+	start = now_ms();
+	for(uint32_t i = 0; i < count; ++i) {
+		px_actor_set_velocity(actors[i], vec3(0, 1, 0));
+	}
+	report(name, "ns/actor_set_velocity", (now_ms() - start) * 1e6 / count, "ns");
+
+	// Fixed per step cost of a scene without actors, at a real dt so a step actually runs
+	Px_Scene empty_scene = create_scene();
+	uint32_t num_steps = 100;
+	start = now_ms();
+	for(uint32_t i = 0; i < num_steps; ++i) {
+		px_scene_simulate(empty_scene, 1.0f / 60.0f, gScratch, SCRATCH_SIZE);
+	}
+	report(name, "ns/simulate empty scene 60hz", (now_ms() - start) * 1e6 / num_steps, "ns");
+	px_scene_release(empty_scene);
+	report_memory(name);
+
+	free(transforms);
+	release_actors(actors, count);
+	px_scene_release(scene);
+	free(actors);
+	free(descriptions);
+}
+
+static int selected(int argc, char** argv, char const* scenario) {
+	int any = 0;
+	for(int i = 1; i < argc; ++i) {
+		if(strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "--scale") == 0) {
+			++i;
+			continue;
+		}
+		if(argv[i][0] == '-') {
+			continue;
+		}
+		any = 1;
+		if(strcmp(argv[i], scenario) == 0) {
+			return 1;
+		}
+	}
+	return !any;
+}
+
+int main(int argc, char** argv) {
+	bool pool = false;
+	for(int i = 1; i < argc; ++i) {
+		if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			gThreads = (uint32_t) atoi(argv[i + 1]);
+		}
+		else if(strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+			gScale = (float) atof(argv[i + 1]);
+		}
+		else if(strcmp(argv[i], "--track") == 0) {
+			gTrack = true;
+		}
+		else if(strcmp(argv[i], "--pool") == 0) {
+			pool = true;
+		}
+	}
+
+	Px_Allocator allocator = {0};
+	allocator.allocate_16_byte_aligned = tracking_allocate;
+	allocator.deallocate = tracking_deallocate;
+	allocator.user_data = &gStats;
+	allocator.track_allocations = gTrack;
+	allocator.pool_small_allocations = pool;
+	Px_Dispatcher_Settings dispatcher_settings = {0};
+	dispatcher_settings.num_threads = gThreads;
+	px_init(allocator, true, false, dispatcher_settings);
+	gScratch = aligned_alloc(16 * 1024, SCRATCH_SIZE);
+
+	printf("physx_lib bench, %u threads, scale %.2f%s%s\n", gThreads, gScale, gTrack ? ", tracking" : "", pool ? ", pooled" : "");
+	report("init", "memory", atomic_load(&gStats.current) / (1024.0 * 1024.0), "MB");
+
+	Px_Material material = px_material_create(0.5f, 0.5f, 0.1f);
+	if(selected(argc, argv, "box_stacks")) bench_box_stacks(material);
+	if(selected(argc, argv, "pile")) bench_pile(material);
+	if(selected(argc, argv, "ragdolls")) bench_ragdolls(material);
+	if(selected(argc, argv, "ray_storm")) bench_ray_storm(material);
+	if(selected(argc, argv, "controllers")) bench_controllers(material);
+	if(selected(argc, argv, "cooking")) bench_cooking();
+	if(selected(argc, argv, "api")) bench_api(material);
+	px_material_release(material);
+
+	free(gScratch);
+	px_destroy();
+	return 0;
+}
@@ -0,0 +1,66 @@
+#!/bin/sh
+# Linux counterpart of build.bat. Builds PhysX as static libraries, merges them with the wrapper into
+# lib/libphysx_lib.a and builds the benchmark. Pass --skip-physx to only rebuild the wrapper and the benchmark.
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+cd "$root"
+
+# Build physx
+if [ "$1" != "--skip-physx" ]; then
+	mkdir -p physx_lib
+	(
+		cd physx_lib
+		cmake "$root/PhysX/physx/source/compiler/cmake/" \
+		 -DTARGET_BUILD_PLATFORM=linux \
+		 -DPX_OUTPUT_ARCH=x86 \
+		 --no-warn-unused-cli \
+		 -DCMAKE_PREFIX_PATH="$root/PhysX/externals/CMakeModules;$root/PhysX/externals/targa" \
+		 -DPHYSX_ROOT_DIR="$root/PhysX/physx" \
+		 -DPX_OUTPUT_LIB_DIR="$root/PhysX/lib" \
+		 -DPX_OUTPUT_BIN_DIR="$root/PhysX/physx" \
+		 -DPX_BUILDSNIPPETS=FALSE \
+		 -DPX_BUILDPUBLICSAMPLES=FALSE \
+		 -DPX_GENERATE_STATIC_LIBRARIES=TRUE \
+		 -DPX_FLOAT_POINT_PRECISE_MATH=FALSE \
+		 -DCMAKE_BUILD_TYPE=profile \
+		 -DPM_CMakeModules_PATH="$root/PhysX/externals/CMakeModules" \
+		 -DCMAKEMODULES_PATH="$root/PhysX/externals/CMakeModules" \
+		 -DPXSHARED_PATH="$root/PhysX/pxshared"
+		make -j"$(nproc)"
+	)
+
+	# copy libs to physx_lib folder for easier linking
+	find "$root/PhysX" -name "*.a" -exec cp -f {} physx_lib/ \;
+fi
+
+# Compile c wrapper lib
+mkdir -p lib
+
+libs="
+ physx_lib/libPhysX_static_64.a
+ physx_lib/libPhysXCharacterKinematic_static_64.a
+ physx_lib/libPhysXCommon_static_64.a
+ physx_lib/libPhysXCooking_static_64.a
+ physx_lib/libPhysXExtensions_static_64.a
+ physx_lib/libPhysXFoundation_static_64.a
+ physx_lib/libPhysXPvdSDK_static_64.a
+ physx_lib/libPhysXVehicle_static_64.a
+"
+
+c++ -std=c++11 -O2 -g -fPIC -DNDEBUG -IPhysX/physx/include -IPhysX/pxshared/include -c physx_lib.cpp -o lib/physx_lib.o
+
+# Merge everything into one archive, like lib.exe does on windows
+rm -f lib/libphysx_lib.a
+{
+	echo "create lib/libphysx_lib.a"
+	echo "addmod lib/physx_lib.o"
+	for l in $libs; do
+		echo "addlib $l"
+	done
+	echo "save"
+	echo "end"
+} | ar -M
+
+# Benchmark
+cc -std=c11 -O2 -g -Wall bench/bench.c lib/libphysx_lib.a -lstdc++ -lpthread -ldl -lm -o bench/bench
@@ -3,7 +3,11 @@ package physx
 import "core:math/linalg"
 import "core:mem"
 
-when ODIN_OS == .Windows do foreign import physx {"lib/physx_lib.lib"}
+when ODIN_OS == .Windows {
+	foreign import physx {"lib/physx_lib.lib"}
+} else when ODIN_OS == .Linux {
+	foreign import physx {"lib/libphysx_lib.a", "system:stdc++", "system:pthread", "system:dl", "system:m"}
+}
 
 Transform :: struct {
 	q : linalg.Quaternionf32,
@@ -16,11 +20,53 @@ Actor :: distinct rawptr
 Triangle_Mesh :: distinct rawptr
 Convex_Mesh :: distinct rawptr
 Controller :: distinct rawptr
+Shape :: distinct rawptr
+Dispatcher :: distinct rawptr
+Task :: distinct rawptr
+Pruning_Structure :: distinct rawptr
+Collection :: distinct rawptr
+Obstacle_Context :: distinct rawptr
+Obstacle :: distinct u32
+
+Simulation_Complete_Callback :: #type proc "c" (scene : Scene, user_data : rawptr)
+
+// Called by PhysX to hand a task to an external job system. The job system must call task_run(task) exactly once,
+// on any thread.
+Submit_Task_Callback :: #type proc "c" (task : Task, user_data : rawptr)
+
+// Zero initialized settings give 4 worker threads without affinity
+Dispatcher_Settings :: struct {
+	num_threads : u32, // Worker threads to create, or the worker count reported to PhysX when submit_task is set. 0 for 4.
+	affinity_masks : ^u32, // Optional, one per thread
+	submit_task : Submit_Task_Callback, // Optional, runs tasks on an external job system instead of creating threads
+	user_data : rawptr,
+}
 
 Allocator :: struct {
 	allocate_16_byte_aligned : #type proc "c" (allocator : ^Allocator, size : u64, filename : cstring, line : i32) -> rawptr,
 	deallocate : #type proc "c" (allocator : ^Allocator, ptr : rawptr),
 	user_data : rawptr,
+	track_allocations : bool, // Per type/file accounting, see allocator_get_stats/allocator_get_sites
+	pool_small_allocations : bool, // Serve allocations up to 1K from built-in size class pools instead of the callbacks
+}
+
+// All zero unless Allocator.track_allocations was set
+Allocation_Stats :: struct {
+	bytes : u64,
+	peak_bytes : u64,
+	count : u64, // Live allocations
+	total_count : u64, // Since init
+	frame_count : u64, // Since allocator_begin_frame
+	pool_reserved_bytes : u64, // Held by the size class pools, whether in use or not
+}
+
+// Allocations grouped by PhysX's type name and source file
+Allocation_Site :: struct {
+	type_name : cstring,
+	filename : cstring,
+	bytes : u64,
+	count : u64,
+	total_count : u64,
 }
 
 Buffer :: struct {
@@ -37,6 +83,89 @@ Mesh_Description :: struct {
 	triangle_stride : u32,
 }
 
+Shape_Type :: enum i32 {
+	eSHAPE_BOX,
+	eSHAPE_SPHERE,
+	eSHAPE_TRIANGLE_MESH,
+	eSHAPE_CONVEX_MESH,
+}
+
+// Box uses half_extents, sphere uses radius, meshes use triangle_mesh/convex_mesh.
+// A zero initialized local_pose is treated as identity.
+// Triangle meshes only take part in simulation on static actors and can't be triggers.
+Shape_Description :: struct {
+	type : Shape_Type,
+	half_extents : linalg.Vector3f32,
+	radius : f32,
+	triangle_mesh : Triangle_Mesh,
+	convex_mesh : Convex_Mesh,
+	local_pose : Transform,
+	material : Material,
+	shape_layer_index : u32, // 0-63
+	mask_index : u32, // 0-63
+	trigger : bool,
+}
+
+Actor_Type :: enum i32 {
+	eACTOR_DYNAMIC,
+	eACTOR_KINEMATIC,
+	eACTOR_STATIC,
+}
+
+// A zero initialized transform is treated as identity
+Actor_Description :: struct {
+	type : Actor_Type,
+	transform : Transform,
+	shapes : ^Shape_Description,
+	num_shapes : u32,
+	density : f32, // 0 for 1
+	user_data : rawptr,
+}
+
+Midphase :: enum i32 {
+	eMIDPHASE_BVH34,
+	eMIDPHASE_BVH33,
+}
+
+// Zero initialized options give the defaults
+Cooking_Options :: struct {
+	midphase : Midphase,
+	bvh34_prims_per_leaf : u32, // 4-15, 0 for 4. Higher cooks faster and uses less memory, queries get slower.
+	weld_tolerance : f32, // Welds vertices closer than this when > 0
+	disable_mesh_cleaning : bool, // Input must already be free of degenerate and duplicate triangles
+	disable_active_edges_precompute : bool, // Faster cooking, less accurate contacts against mesh edges
+	flip_normals : bool,
+	convex_vertex_limit : u16, // 4-255, 0 for 255
+	gpu_compatible : bool, // Builds extra data for GPU simulation, off by default
+}
+
+Mesh_Type :: enum i32 {
+	eMESH_TRIANGLE,
+	eMESH_CONVEX,
+}
+
+// Mesh created from a mesh archive, only the handle matching type is set
+Archive_Mesh :: struct {
+	type : Mesh_Type,
+	triangle_mesh : Triangle_Mesh,
+	convex_mesh : Convex_Mesh,
+}
+
+// Dynamic state of an actor for rollback, sleeping actors restore with zero velocity
+Actor_State :: struct {
+	actor : Actor,
+	transform : Transform,
+	linear_velocity : linalg.Vector3f32,
+	angular_velocity : linalg.Vector3f32,
+	wake_counter : f32,
+	sleeping : bool,
+}
+
+Pose_Preview :: struct {
+	actor : Actor,
+	transform : Transform,
+}
+
 Contact :: struct {
 	actor0 : Actor,
 	actor1 : Actor,
@@ -45,6 +174,34 @@ Contact :: struct {
 	impulse : linalg.Vector3f32,
 }
 
+Contact_State :: enum i32 {
+	eCONTACT_TOUCH_FOUND,
+	eCONTACT_TOUCH_PERSISTS,
+	eCONTACT_TOUCH_LOST,
+}
+
+// Same layout as PxContactPairPoint.
+// Face indices are only meaningful for mesh shapes and resolve per-triangle materials.
+Contact_Point :: struct {
+	pos : linalg.Vector3f32,
+	separation : f32,
+	normal : linalg.Vector3f32,
+	face_index0 : u32,
+	impulse : linalg.Vector3f32,
+	face_index1 : u32,
+}
+
+// Points are contact_points[first_point : first_point + num_points]. Lost pairs have no points.
+Contact_Pair :: struct {
+	actor0 : Actor,
+	actor1 : Actor,
+	shape0 : Shape,
+	shape1 : Shape,
+	state : Contact_State,
+	first_point : u32,
+	num_points : u32,
+}
+
 Trigger_State :: enum i32 {
 	eNOTIFY_TOUCH_FOUND,
 	eNOTIFY_TOUCH_LOST,
@@ -63,6 +220,85 @@ Query_Hit :: struct {
 }
 
 
+// Zero initialized settings give the defaults
+Scene_Settings :: struct {
+	initial_event_capacity : u32, // Contacts/triggers reserved up front, 0 for 256
+	max_event_capacity : u32, // Events past this are dropped and counted, 0 for unbounded
+	fixed_step : f32, // Step with this fixed dt, accumulating the dt passed to simulate. 0 to step with the passed dt.
+	max_substeps : u32, // Max fixed steps per simulate call, excess time is dropped. 0 for 4.
+	dispatcher : Dispatcher, // Optional, uses the dispatcher created by init when nil
+	export_contact_points : bool, // Report every contact point and persist/lost pairs through scene_get_contact_pairs instead of scene_get_contacts
+	pose_preview_capacity : u32, // Poses kept per step for scene_get_pose_previews, 0 for 256
+	enable_stabilization : bool, // Dampens slow bodies so piles settle and fall asleep sooner, see actor_set_stabilization_threshold
+	enable_ccd : bool, // Allows swept CCD for actors with actor_set_ccd. Speculative CCD works without it.
+	ccd_layers : u64, // Layers whose contact pairs are swept when enable_ccd is set, 0 for all. See scene_set_ccd_layers.
+}
+// Hit actor is nil when nothing was hit. Overlaps only fill actor, shape and face_index.
+Query_Batch_Hit :: struct {
+	actor : Actor,
+	shape : Shape,
+	pos : linalg.Vector3f32,
+	normal : linalg.Vector3f32,
+	distance : f32,
+	face_index : u32,
+}
+
+Query_Geometry_Type :: enum i32 {
+	eQUERY_GEOMETRY_SPHERE,
+	eQUERY_GEOMETRY_BOX,
+	eQUERY_GEOMETRY_CAPSULE,
+}
+
+// Sphere uses radius, box uses half_extents, capsule uses radius and half_height along the x axis
+Query_Geometry :: struct {
+	type : Query_Geometry_Type,
+	half_extents : linalg.Vector3f32,
+	radius : f32,
+	half_height : f32,
+}
+
+// Counters come from PxSimulationStatistics of the last substep, timings are wall clock milliseconds of the
+// last scene_simulate_begin/end summed over its substeps
+Scene_Stats :: struct {
+	num_active_constraints : u32,
+	num_active_dynamic_bodies : u32,
+	num_active_kinematic_bodies : u32,
+	num_static_bodies : u32,
+	num_dynamic_bodies : u32,
+	num_kinematic_bodies : u32,
+	num_axis_solver_constraints : u32,
+	num_partitions : u32,
+	num_broad_phase_adds : u32,
+	num_broad_phase_removes : u32,
+	num_discrete_contact_pairs : u32,
+	num_discrete_contact_pairs_with_cache_hits : u32,
+	num_discrete_contact_pairs_with_contacts : u32,
+	num_new_pairs : u32,
+	num_lost_pairs : u32,
+	num_new_touches : u32,
+	num_lost_touches : u32,
+	compressed_contact_size : u32,
+	required_contact_constraint_memory : u32,
+	peak_constraint_memory : u32,
+
+	num_substeps : u32,
+	simulate_ms : f32,
+	// Includes event collection
+	fetch_results_ms : f32,
+	// Only measured while the profiler is enabled, see profiler_enable
+	event_collection_ms : f32,
+	// Controller moves between the previous and the last scene_simulate_begin
+	controller_move_ms : f32,
+}
+
+// Bits match PxControllerCollisionFlag
+Controller_Collision_Flag :: enum u8 {
+	eCONTROLLER_COLLISION_SIDES,
+	eCONTROLLER_COLLISION_UP,
+	eCONTROLLER_COLLISION_DOWN,
+}
+Controller_Collision_Flags :: bit_set[Controller_Collision_Flag; u8]
+
 Controller_Settings :: struct {
 	slope_limit_deg : f32,
 	height : f32,
@@ -71,20 +307,68 @@ Controller_Settings :: struct {
 	shape_layer_index : i32,
 	mask_index : i32,
 	material : Material,
+	position : linalg.Vector3f32, // Center of the capsule
+	step_offset : f32, // 0 for 0.05
+	contact_offset : f32, // 0 for 0.01
+	min_distance : f32, // Moves shorter than this are skipped, 0 for 0.001
+	volume_growth : f32, // Size of the cached query volume around the controller relative to its bounds, 0 for PhysX's 1.5
+}
+
+// Shared by all controllers of a scene. Zero initialized settings are PhysX's defaults.
+Controller_Manager_Settings :: struct {
+	tessellation : bool, // Tessellates large triangles the controllers touch, improves collision against big triangles
+	max_edge_length : f32, // For tessellation
+	disable_overlap_recovery : bool, // Cheaper, but controllers can stay stuck in penetration
+	disable_precise_sweeps : bool, // Cheaper, less accurate sweeps
+	prevent_vertical_sliding_against_ceiling : bool,
 }
 
 @(default_calling_convention="c")
 foreign physx {
 
 	@(link_name="px_init")
-	init :: proc(allocator : Allocator, initialize_cooking : bool, initialize_pvd : bool) ---
+	init :: proc(allocator : Allocator, initialize_cooking : bool, initialize_pvd : bool, dispatcher_settings : Dispatcher_Settings = {}) ---
 
 	@(link_name="px_destroy")
 	destroy :: proc() ---
 
+	@(link_name="px_allocator_get_stats")
+	allocator_get_stats :: proc() -> Allocation_Stats ---
+
+	// Returns the number of sites, up to capacity of them are written to sites_out
+	@(link_name="px_allocator_get_sites")
+	_allocator_get_sites :: proc(sites_out : ^Allocation_Site, capacity : u32) -> u32 ---
+
+	// Resets Allocation_Stats.frame_count, call once per frame to count per frame allocations
+	@(link_name="px_allocator_begin_frame")
+	allocator_begin_frame :: proc() ---
+
+
+	// Records PhysX profiler zones (profile and checked PhysX builds only) into a ring buffer of capacity zones,
+	// 0 disables it. Replaces PVD's profiling. Enable, clear and write between steps.
+	@(link_name="px_profiler_enable")
+	profiler_enable :: proc(capacity : u32) ---
+
+	@(link_name="px_profiler_clear")
+	profiler_clear :: proc() ---
+
+	// Writes the recorded zones as Chrome trace event JSON (chrome://tracing, Perfetto)
+	@(link_name="px_profiler_write_chrome_trace")
+	profiler_write_chrome_trace :: proc(path : cstring) -> bool ---
+
+
+	@(link_name="px_dispatcher_create")
+	dispatcher_create :: proc(settings : Dispatcher_Settings) -> Dispatcher ---
+
+	@(link_name="px_dispatcher_release")
+	dispatcher_release :: proc(dispatcher : Dispatcher) ---
+
+	@(link_name="px_task_run")
+	task_run :: proc(task : Task) ---
+
 
 	@(link_name="px_scene_create")
-	scene_create :: proc() -> Scene ---
+	scene_create :: proc(settings : Scene_Settings = {}) -> Scene ---
 
 	@(link_name="px_scene_release")
 	scene_release :: proc(scene : Scene) ---
@@ -92,31 +376,147 @@ foreign physx {
 	@(link_name="px_scene_simulate")
 	scene_simulate :: proc(scene : Scene, dt : f32, scratch_memory_16_byte_aligned : rawptr = nil, scratch_size : u64 = 0) ---
 
+	// In fixed step mode only the first substep runs asynchronously, the others run blocking inside scene_simulate_end.
+	// Kinematic targets are reached by the end of the first substep and the actor holds still for the rest.
+	@(link_name="px_scene_simulate_begin")
+	scene_simulate_begin :: proc(scene : Scene, dt : f32, scratch_memory_16_byte_aligned : rawptr = nil, scratch_size : u64 = 0) ---
+
+	// True once the first substep is done. scene_simulate_end can still block on further substeps.
+	@(link_name="px_scene_simulate_poll")
+	scene_simulate_poll :: proc(scene : Scene) -> bool ---
+
+	@(link_name="px_scene_simulate_end")
+	scene_simulate_end :: proc(scene : Scene) ---
+
+	@(link_name="px_scenes_simulate")
+	_scenes_simulate :: proc(scenes : ^Scene, count : u32, dt : f32, scratch_memory_16_byte_aligned : rawptr, scratch_size : u64) ---
+
+	// Fraction of a fixed step left in the accumulator after the last simulate call, 1 when not in fixed step mode
+	@(link_name="px_scene_get_interpolation_alpha")
+	scene_get_interpolation_alpha :: proc(scene : Scene) -> f32 ---
+
+	// Called from a worker thread once the first substep of a step is done. Results still have to be fetched with scene_simulate_end.
+	@(link_name="px_scene_set_simulation_complete_callback")
+	scene_set_simulation_complete_callback :: proc(scene : Scene, callback : Simulation_Complete_Callback, user_data : rawptr = nil) ---
+
 	@(link_name="px_scene_set_gravity")
 	scene_set_gravity :: proc(scene : Scene, gravity : linalg.Vector3f32) ---
 
 	@(link_name="px_scene_add_actor")
 	scene_add_actor :: proc(scene : Scene, actor : Actor) ---
 
+	@(link_name="px_scene_add_actors")
+	_scene_add_actors :: proc(scene : Scene, actors : ^Actor, count : u32) ---
+
+	// Prebuilds the scene query structure for actors not yet in a scene, can be done off the simulation thread.
+	// Adding it to a scene adds all its actors and releases the structure.
+	@(link_name="px_pruning_structure_create")
+	_pruning_structure_create :: proc(actors : ^Actor, count : u32) -> Pruning_Structure ---
+
+	@(link_name="px_pruning_structure_release")
+	pruning_structure_release :: proc(pruning_structure : Pruning_Structure) ---
+
+	@(link_name="px_scene_add_pruning_structure")
+	scene_add_pruning_structure :: proc(scene : Scene, pruning_structure : Pruning_Structure) ---
+
 	@(link_name="px_scene_remove_actor")
 	scene_remove_actor :: proc(scene : Scene, actor : Actor) ---
 
 	@(link_name="px_scene_get_active_actors")
 	_scene_get_active_actors :: proc(scene : Scene, num_active : ^u32) -> ^Actor ---
 
+	@(link_name="px_scene_read_active_transforms")
+	_scene_read_active_transforms :: proc(scene : Scene, actors_out : ^Actor, positions_out : ^linalg.Vector3f32, rotations_out : ^linalg.Quaternionf32, user_data_out : ^rawptr, linear_velocities_out : ^linalg.Vector3f32, angular_velocities_out : ^linalg.Vector3f32, capacity : u32) -> u32 ---
+
+	@(link_name="px_scene_read_active_transforms_interpolated")
+	_scene_read_active_transforms_interpolated :: proc(scene : Scene, actors_out : ^Actor, positions_out : ^linalg.Vector3f32, rotations_out : ^linalg.Quaternionf32, previous_positions_out : ^linalg.Vector3f32, previous_rotations_out : ^linalg.Quaternionf32, user_data_out : ^rawptr, capacity : u32) -> u32 ---
+
 	@(link_name="px_scene_get_contacts")
 	_scene_get_contacts :: proc(scene : Scene, num_contacts : ^u32) -> ^Contact ---
 
+	@(link_name="px_scene_get_contact_pairs")
+	_scene_get_contact_pairs :: proc(scene : Scene, num_pairs : ^u32) -> ^Contact_Pair ---
+
+	@(link_name="px_scene_get_contact_points")
+	_scene_get_contact_points :: proc(scene : Scene, num_points : ^u32) -> ^Contact_Point ---
+
 	@(link_name="px_scene_get_triggers")
 	_scene_get_triggers :: proc(scene : Scene, num_triggers : ^u32) -> ^Trigger ---
 
+	// Integrated poses of actors with pose preview enabled, readable from any thread while the step is still running.
+	// Grows as PhysX integrates bodies, entries up to the returned count are final. Reset by every simulate call,
+	// so with substeps only the running substep is visible. CCD can still move bodies after their preview.
+	@(link_name="px_scene_get_pose_previews")
+	_scene_get_pose_previews :: proc(scene : Scene, num_poses : ^u32) -> ^Pose_Preview ---
+
+	// Dynamic actors that woke up or fell asleep during the last step, including through API calls such as setting a velocity
+	@(link_name="px_scene_get_woken_actors")
+	_scene_get_woken_actors :: proc(scene : Scene, num_actors : ^u32) -> ^Actor ---
+
+	@(link_name="px_scene_get_sleeping_actors")
+	_scene_get_sleeping_actors :: proc(scene : Scene, num_actors : ^u32) -> ^Actor ---
+
+
+	@(link_name="px_scene_get_stats")
+	scene_get_stats :: proc(scene : Scene) -> Scene_Stats ---
+
+	// Number of events dropped during the last step because max_event_capacity was hit or the allocator failed
+	@(link_name="px_scene_get_event_overflow")
+	scene_get_event_overflow :: proc(scene : Scene, dropped_contacts : ^u32, dropped_triggers : ^u32, dropped_sleep_events : ^u32 = nil, dropped_pose_previews : ^u32 = nil) ---
+
+	// Binary serialization of a scene's actors. Materials, meshes and shared shapes go into a separate shared collection
+	// so they are stored and loaded once for any number of scene snapshots.
+	// Serialize procs write to buffer if it is large enough and return the required size either way.
+	// Deserialize patches the buffer in place: it must be 128 byte aligned, used only once and outlive the objects created from it.
+	// Shapes from shape_create or the shape cache go into the shared collection, so every snapshot deserialized against it
+	// attaches the same live shapes. Other shapes are exclusive to their actor and stored with each snapshot.
+	@(link_name="px_collection_create_shared")
+	collection_create_shared :: proc(scene : Scene) -> Collection ---
+
+	@(link_name="px_collection_serialize")
+	_collection_serialize :: proc(collection : Collection, buffer : rawptr, capacity : u64) -> u64 ---
+
+	@(link_name="px_collection_deserialize")
+	collection_deserialize :: proc(buffer_128_byte_aligned : rawptr) -> Collection ---
+
+	@(link_name="px_collection_release")
+	collection_release :: proc(collection : Collection, release_objects : bool) ---
+
+	@(link_name="px_scene_serialize")
+	_scene_serialize :: proc(scene : Scene, shared : Collection, buffer : rawptr, capacity : u64) -> u64 ---
+
+	// Adds the actors to the scene. Returns the number of actors, up to capacity of them are written to actors_out.
+	@(link_name="px_scene_deserialize")
+	_scene_deserialize :: proc(scene : Scene, shared : Collection, buffer_128_byte_aligned : rawptr, actors_out : ^Actor, capacity : u32) -> u32 ---
+
+	// Lightweight snapshot of all dynamic actors for rollback. Returns the number of dynamic actors, which may exceed capacity.
+	@(link_name="px_scene_save_state")
+	_scene_save_state :: proc(scene : Scene, states_out : ^Actor_State, capacity : u32) -> u32 ---
+
+	@(link_name="px_actors_restore_state")
+	_actors_restore_state :: proc(states : ^Actor_State, count : u32) ---
 
 	@(link_name="px_scene_set_collision_mask")
 	scene_set_collision_mask :: proc(scene : Scene, mask_index : i32, layer_mask : u64) ---
 
+	// Pairs where either shape is on one of these layers get swept CCD contacts. Needs enable_ccd in the scene settings.
+	// Unlike the ccd_layers scene setting, 0 here means no layers.
+	// Applied to simulation from the next scene_simulate_begin.
+	@(link_name="px_scene_set_ccd_layers")
+	scene_set_ccd_layers :: proc(scene : Scene, layer_mask : u64) ---
+
 	@(link_name="px_scene_raycast")
 	scene_raycast :: proc(scene : Scene, origin : linalg.Vector3f32, direction : linalg.Vector3f32, distance : f32, mask_index : i32) -> Query_Hit ---
 
+	@(link_name="px_scene_raycast_batch")
+	_scene_raycast_batch :: proc(scene : Scene, origins : ^linalg.Vector3f32, directions : ^linalg.Vector3f32, distances : ^f32, mask_indices : ^u32, count : u32, hits_out : ^Query_Batch_Hit) ---
+
+	@(link_name="px_scene_sweep_batch")
+	_scene_sweep_batch :: proc(scene : Scene, geometry : Query_Geometry, poses : ^Transform, directions : ^linalg.Vector3f32, distances : ^f32, mask_indices : ^u32, count : u32, hits_out : ^Query_Batch_Hit) ---
+
+	@(link_name="px_scene_overlap_batch")
+	_scene_overlap_batch :: proc(scene : Scene, geometry : Query_Geometry, poses : ^Transform, mask_indices : ^u32, count : u32, hits_out : ^Query_Batch_Hit) ---
+
 
 	@(link_name="px_material_create")
 	material_create :: proc(static_friction : f32, dynamic_friction : f32, restitution : f32) -> Material ---
@@ -128,15 +528,54 @@ foreign physx {
 	@(link_name="px_actor_create")
 	actor_create :: proc() -> Actor ---
 
+	@(link_name="px_actor_create_static")
+	_actor_create_static :: proc(transform : Transform, shapes : ^Shape_Description, num_shapes : u32) -> Actor ---
+
+	@(link_name="px_actors_create_batch")
+	_actors_create_batch :: proc(descriptions : ^Actor_Description, count : u32, actors_out : ^Actor) ---
+
 	@(link_name="px_actor_release")
 	actor_release :: proc(actor : Actor) ---
 
+	@(link_name="px_actor_is_static")
+	actor_is_static :: proc(actor : Actor) -> bool ---
+
 	@(link_name="px_actor_get_user_data")
 	actor_get_user_data :: proc(actor : Actor) -> rawptr ---
 
 	@(link_name="px_actor_set_user_data")
 	actor_set_user_data :: proc(actor : Actor, user_data : rawptr) ---
 
+	// Reports the actor's pose through scene_get_pose_previews as soon as it is integrated, before the step completes
+	@(link_name="px_actor_set_pose_preview")
+	actor_set_pose_preview :: proc(actor : Actor, enabled : bool) ---
+
+	// Static actors always count as sleeping
+	@(link_name="px_actor_is_sleeping")
+	actor_is_sleeping :: proc(actor : Actor) -> bool ---
+
+	@(link_name="px_actor_wake_up")
+	actor_wake_up :: proc(actor : Actor) ---
+
+	@(link_name="px_actor_put_to_sleep")
+	actor_put_to_sleep :: proc(actor : Actor) ---
+
+	// Mass normalized kinetic energy below which the actor may fall asleep
+	@(link_name="px_actor_set_sleep_threshold")
+	actor_set_sleep_threshold :: proc(actor : Actor, threshold : f32) ---
+
+	// Mass normalized kinetic energy below which the actor is dampened, when the scene has stabilization enabled
+	@(link_name="px_actor_set_stabilization_threshold")
+	actor_set_stabilization_threshold :: proc(actor : Actor, threshold : f32) ---
+
+	// Sweeps the actor between steps so fast bodies don't tunnel, against pairs on the scene's CCD layers. Ignored for kinematic actors.
+	@(link_name="px_actor_set_ccd")
+	actor_set_ccd :: proc(actor : Actor, enabled : bool) ---
+
+	// Cheaper than swept CCD, grows contact distance with velocity. Also works for kinematic actors.
+	@(link_name="px_actor_set_speculative_ccd")
+	actor_set_speculative_ccd :: proc(actor : Actor, enabled : bool) ---
+
 	@(link_name="px_actor_set_kinematic")
 	actor_set_kinematic :: proc(actor : Actor, kinematic : bool) ---
 
@@ -152,6 +591,36 @@ foreign physx {
 	@(link_name="px_actor_set_velocity")
 	actor_set_velocity :: proc(actor : Actor, linear_velocity : linalg.Vector3f32) ---
 
+	@(link_name="px_actors_set_transforms")
+	_actors_set_transforms :: proc(actors : ^Actor, transforms : ^Transform, transform_stride : u32, count : u32) ---
+
+	@(link_name="px_actors_set_kinematic_targets")
+	_actors_set_kinematic_targets :: proc(actors : ^Actor, transforms : ^Transform, transform_stride : u32, count : u32) ---
+
+	@(link_name="px_actors_set_velocities")
+	_actors_set_velocities :: proc(actors : ^Actor, velocities : ^linalg.Vector3f32, velocity_stride : u32, count : u32) ---
+
+	@(link_name="px_actor_add_shape")
+	actor_add_shape :: proc(actor : Actor, shape : Shape_Description) ---
+
+	@(link_name="px_actor_attach_shape")
+	actor_attach_shape :: proc(actor : Actor, shape : Shape) ---
+
+	// Shapes can be attached to any number of actors. Triangle mesh shapes for dynamic actors are query only.
+	@(link_name="px_shape_create")
+	shape_create :: proc(description : Shape_Description, for_dynamic_actor : bool) -> Shape ---
+
+	@(link_name="px_shape_release")
+	shape_release :: proc(shape : Shape) ---
+
+	// While enabled, shapes created from identical descriptions (including through actor_add_shape* and actor creation)
+	// are shared. The cache keeps its shapes, and their meshes and materials, alive until cleared or destroy.
+	@(link_name="px_shape_cache_set_enabled")
+	shape_cache_set_enabled :: proc(enabled : bool) ---
+
+	@(link_name="px_shape_cache_clear")
+	shape_cache_clear :: proc() ---
+
 	@(link_name="px_actor_add_shape_box")
 	actor_add_shape_box :: proc(actor : Actor, half_extents : linalg.Vector3f32, material : Material, shape_layer_index : i32, mask_index : i32, trigger : bool) ---
 
@@ -165,11 +634,25 @@ foreign physx {
 	actor_add_shape_convex_mesh :: proc(actor : Actor, convex_mesh : Convex_Mesh, material : Material, shape_layer_index : i32, mask_index : i32) ---
 
 
+	// Returns an empty buffer when cooking fails. Failures are never written to the cooking cache.
 	@(link_name="px_cook_triangle_mesh")
-	cook_triangle_mesh :: proc(mesh_description : Mesh_Description) -> Buffer ---
+	cook_triangle_mesh :: proc(mesh_description : Mesh_Description, options : Cooking_Options = {}) -> Buffer ---
 
 	@(link_name="px_cook_convex_mesh")
-	cook_convex_mesh :: proc(mesh_description : Mesh_Description) -> Buffer ---
+	cook_convex_mesh :: proc(mesh_description : Mesh_Description, options : Cooking_Options = {}) -> Buffer ---
+
+	// Cooks many meshes in parallel on the dispatcher's worker threads. Cooking is thread safe, so the single mesh
+	// procs can also be called from several threads at once.
+	@(link_name="px_cook_triangle_meshes")
+	_cook_triangle_meshes :: proc(mesh_descriptions : ^Mesh_Description, count : u32, options : Cooking_Options, buffers_out : ^Buffer) ---
+
+	@(link_name="px_cook_convex_meshes")
+	_cook_convex_meshes :: proc(mesh_descriptions : ^Mesh_Description, count : u32, options : Cooking_Options, buffers_out : ^Buffer) ---
+
+	// Cooked meshes are stored in the directory, keyed by a hash of their input, and loaded from there instead of cooking
+	// them again. The directory must exist. Nil or empty disables the cache. Not thread safe with cooking in progress.
+	@(link_name="px_cooking_set_cache_directory")
+	cooking_set_cache_directory :: proc(directory : cstring) ---
 
 	@(link_name="px_buffer_free")
 	buffer_free :: proc(buffer : Buffer) ---
@@ -181,12 +664,32 @@ foreign physx {
 	@(link_name="px_triangle_mesh_release")
 	triangle_mesh_release :: proc(triangle_mesh : Triangle_Mesh) ---
 
+	// Cooks straight into a mesh without serializing to a buffer, for meshes built at runtime
+	@(link_name="px_triangle_mesh_cook")
+	triangle_mesh_cook :: proc(mesh_description : Mesh_Description, options : Cooking_Options = {}) -> Triangle_Mesh ---
+
 	@(link_name="px_convex_mesh_create")
 	convex_mesh_create :: proc(buffer : Buffer) -> Convex_Mesh ---
 
 	@(link_name="px_convex_mesh_release")
 	convex_mesh_release :: proc(convex_mesh : Convex_Mesh) ---
 
+	@(link_name="px_convex_mesh_cook")
+	convex_mesh_cook :: proc(mesh_description : Mesh_Description, options : Cooking_Options = {}) -> Convex_Mesh ---
+
+
+	// Packs cooked mesh buffers into one archive with an index, free with buffer_free
+	@(link_name="px_mesh_archive_pack")
+	_mesh_archive_pack :: proc(buffers : ^Buffer, types : ^Mesh_Type, count : u32) -> Buffer ---
+
+	// Creates meshes directly from an archive in memory (e.g. a mapped file) or from a file, which is memory mapped.
+	// Returns the number of meshes in the archive, 0 if it isn't valid.
+	@(link_name="px_mesh_archive_load")
+	_mesh_archive_load :: proc(archive : rawptr, archive_size : u64, meshes_out : ^Archive_Mesh, capacity : u32) -> u32 ---
+
+	@(link_name="px_mesh_archive_load_file")
+	_mesh_archive_load_file :: proc(path : cstring, meshes_out : ^Archive_Mesh, capacity : u32) -> u32 ---
+
 
 	@(link_name="px_controller_create")
 	controller_create :: proc(scene : Scene, controller_settings : Controller_Settings) -> Controller ---
@@ -197,11 +700,71 @@ foreign physx {
 	@(link_name="px_controller_get_position")
 	controller_get_position :: proc(controller : Controller) -> linalg.Vector3f32 ---
 
+	// Teleports the controller without checking for collisions
 	@(link_name="px_controller_set_position")
 	controller_set_position :: proc(controller : Controller, position : linalg.Vector3f32) ---
 
+	// Bottom of the capsule, including the contact offset
+	@(link_name="px_controller_get_foot_position")
+	controller_get_foot_position :: proc(controller : Controller) -> linalg.Vector3f32 ---
+
+	@(link_name="px_controller_set_foot_position")
+	controller_set_foot_position :: proc(controller : Controller, position : linalg.Vector3f32) ---
+
+	@(link_name="px_controller_set_step_offset")
+	controller_set_step_offset :: proc(controller : Controller, step_offset : f32) ---
+
+	@(link_name="px_controller_set_contact_offset")
+	controller_set_contact_offset :: proc(controller : Controller, contact_offset : f32) ---
+
+	@(link_name="px_controller_set_min_distance")
+	controller_set_min_distance :: proc(controller : Controller, min_distance : f32) ---
+
+	// Moves of the controller collide with the context's obstacles, nil to stop using one. The context must outlive its use.
+	@(link_name="px_controller_set_obstacle_context")
+	controller_set_obstacle_context :: proc(controller : Controller, obstacle_context : Obstacle_Context) ---
+
+	@(link_name="px_scene_set_controller_manager_settings")
+	scene_set_controller_manager_settings :: proc(scene : Scene, settings : Controller_Manager_Settings) ---
+
+	// Obstacles are only seen by controllers, much cheaper to move around than kinematic actors.
+	// Capsule obstacles are aligned to their local x axis.
+	@(link_name="px_obstacle_context_create")
+	obstacle_context_create :: proc(scene : Scene) -> Obstacle_Context ---
+
+	@(link_name="px_obstacle_context_release")
+	obstacle_context_release :: proc(obstacle_context : Obstacle_Context) ---
+
+	@(link_name="px_obstacle_context_add_box")
+	obstacle_context_add_box :: proc(obstacle_context : Obstacle_Context, transform : Transform, half_extents : linalg.Vector3f32) -> Obstacle ---
+
+	@(link_name="px_obstacle_context_add_capsule")
+	obstacle_context_add_capsule :: proc(obstacle_context : Obstacle_Context, transform : Transform, radius : f32, half_height : f32) -> Obstacle ---
+
+	@(link_name="px_obstacle_context_update_box")
+	obstacle_context_update_box :: proc(obstacle_context : Obstacle_Context, obstacle : Obstacle, transform : Transform, half_extents : linalg.Vector3f32) -> bool ---
+
+	@(link_name="px_obstacle_context_update_capsule")
+	obstacle_context_update_capsule :: proc(obstacle_context : Obstacle_Context, obstacle : Obstacle, transform : Transform, radius : f32, half_height : f32) -> bool ---
+
+	@(link_name="px_obstacle_context_remove")
+	obstacle_context_remove :: proc(obstacle_context : Obstacle_Context, obstacle : Obstacle) -> bool ---
+
 	@(link_name="px_controller_move")
 	controller_move :: proc(controller : Controller, displacement : linalg.Vector3f32, dt : f32, mask_index : i32) ---
+
+	// Moves controllers of one scene. Collision flags and the resulting positions are written to the optional output arrays.
+	// With parallel_cell_size 0 controllers are moved in order on the calling thread, otherwise they are grouped by cells
+	// of that size and non-adjacent cells are moved in parallel on the scene's dispatcher.
+	// Falls back to moving in order when a controller's size plus displacement reaches past half a cell.
+	@(link_name="px_controllers_move_batch")
+	_controllers_move_batch :: proc(controllers : ^Controller, displacements : ^linalg.Vector3f32, mask_indices : ^u32, count : u32, dt : f32, parallel_cell_size : f32, collision_flags_out : ^Controller_Collision_Flags, positions_out : ^linalg.Vector3f32) ---
+}
+
+// Steps all scenes concurrently and waits once. Substeps run in lockstep, so scenes overlap on every substep.
+// Scratch memory is split evenly between the scenes in blocks of a multiple of 16K.
+scenes_simulate :: proc(scenes : []Scene, dt : f32, scratch_memory_16_byte_aligned : []byte = nil) {
+	_scenes_simulate(raw_data(scenes), cast(u32) len(scenes), dt, raw_data(scratch_memory_16_byte_aligned), cast(u64) len(scratch_memory_16_byte_aligned))
 }
 
 scene_get_active_actors :: proc(scene : Scene) -> []Actor {
@@ -210,14 +773,180 @@ scene_get_active_actors :: proc(scene : Scene) -> []Actor {
 	return mem.slice_ptr(result, cast(int) num)
 }
 
+// Pass nil for any array that isn't needed. All non-nil arrays must be at least as long as actors.
+// Returns the total number of active actors, which may exceed len(actors).
+scene_read_active_transforms :: proc(scene : Scene, actors : []Actor, positions : []linalg.Vector3f32, rotations : []linalg.Quaternionf32, user_data : []rawptr = nil, linear_velocities : []linalg.Vector3f32 = nil, angular_velocities : []linalg.Vector3f32 = nil) -> int {
+	capacity := len(actors)
+	assert(positions == nil || len(positions) >= capacity)
+	assert(rotations == nil || len(rotations) >= capacity)
+	assert(user_data == nil || len(user_data) >= capacity)
+	assert(linear_velocities == nil || len(linear_velocities) >= capacity)
+	assert(angular_velocities == nil || len(angular_velocities) >= capacity)
+	return cast(int) _scene_read_active_transforms(scene, raw_data(actors), raw_data(positions), raw_data(rotations), raw_data(user_data), raw_data(linear_velocities), raw_data(angular_velocities), cast(u32) capacity)
+}
+
+// Like scene_read_active_transforms, but positions/rotations are interpolated by the scene's interpolation alpha between
+// the previous pose (start of the last substep, also written to the optional previous arrays) and the current pose.
+// Previous poses are recorded before each step's last substep from the first call on, until then the current pose is used.
+// Actors that were asleep going into the last substep use their current pose as the previous one.
+scene_read_active_transforms_interpolated :: proc(scene : Scene, actors : []Actor, positions : []linalg.Vector3f32, rotations : []linalg.Quaternionf32, previous_positions : []linalg.Vector3f32 = nil, previous_rotations : []linalg.Quaternionf32 = nil, user_data : []rawptr = nil) -> int {
+	capacity := len(actors)
+	assert(positions == nil || len(positions) >= capacity)
+	assert(rotations == nil || len(rotations) >= capacity)
+	assert(previous_positions == nil || len(previous_positions) >= capacity)
+	assert(previous_rotations == nil || len(previous_rotations) >= capacity)
+	assert(user_data == nil || len(user_data) >= capacity)
+	return cast(int) _scene_read_active_transforms_interpolated(scene, raw_data(actors), raw_data(positions), raw_data(rotations), raw_data(previous_positions), raw_data(previous_rotations), raw_data(user_data), cast(u32) capacity)
+}
+
 scene_get_contacts :: proc(scene : Scene) -> []Contact {
 	num: u32
 	result := _scene_get_contacts(scene, &num)
 	return mem.slice_ptr(result, cast(int) num)
 }
 
+scene_get_contact_pairs :: proc(scene : Scene) -> []Contact_Pair {
+	num: u32
+	result := _scene_get_contact_pairs(scene, &num)
+	return mem.slice_ptr(result, cast(int) num)
+}
+
+scene_get_contact_points :: proc(scene : Scene) -> []Contact_Point {
+	num: u32
+	result := _scene_get_contact_points(scene, &num)
+	return mem.slice_ptr(result, cast(int) num)
+}
+
 scene_get_triggers :: proc(scene : Scene) -> []Trigger {
 	num: u32
 	result := _scene_get_triggers(scene, &num)
 	return mem.slice_ptr(result, cast(int) num)
 }
+
+// The returned slice stays valid for the step, call again to see poses published since
+scene_get_pose_previews :: proc(scene : Scene) -> []Pose_Preview {
+	num: u32
+	result := _scene_get_pose_previews(scene, &num)
+	return mem.slice_ptr(result, cast(int) num)
+}
+
+scene_get_woken_actors :: proc(scene : Scene) -> []Actor {
+	num: u32
+	result := _scene_get_woken_actors(scene, &num)
+	return mem.slice_ptr(result, cast(int) num)
+}
+
+scene_get_sleeping_actors :: proc(scene : Scene) -> []Actor {
+	num: u32
+	result := _scene_get_sleeping_actors(scene, &num)
+	return mem.slice_ptr(result, cast(int) num)
+}
+
+scene_raycast_batch :: proc(scene : Scene, origins : []linalg.Vector3f32, directions : []linalg.Vector3f32, distances : []f32, mask_indices : []u32, hits_out : []Query_Batch_Hit) {
+	count := len(origins)
+	assert(len(directions) >= count && len(distances) >= count && len(mask_indices) >= count && len(hits_out) >= count)
+	_scene_raycast_batch(scene, raw_data(origins), raw_data(directions), raw_data(distances), raw_data(mask_indices), cast(u32) count, raw_data(hits_out))
+}
+
+scene_sweep_batch :: proc(scene : Scene, geometry : Query_Geometry, poses : []Transform, directions : []linalg.Vector3f32, distances : []f32, mask_indices : []u32, hits_out : []Query_Batch_Hit) {
+	count := len(poses)
+	assert(len(directions) >= count && len(distances) >= count && len(mask_indices) >= count && len(hits_out) >= count)
+	_scene_sweep_batch(scene, geometry, raw_data(poses), raw_data(directions), raw_data(distances), raw_data(mask_indices), cast(u32) count, raw_data(hits_out))
+}
+
+scene_overlap_batch :: proc(scene : Scene, geometry : Query_Geometry, poses : []Transform, mask_indices : []u32, hits_out : []Query_Batch_Hit) {
+	count := len(poses)
+	assert(len(mask_indices) >= count && len(hits_out) >= count)
+	_scene_overlap_batch(scene, geometry, raw_data(poses), raw_data(mask_indices), cast(u32) count, raw_data(hits_out))
+}
+
+// Returns the required size, buffer is only written if it is large enough
+collection_serialize :: proc(collection : Collection, buffer : []byte) -> int {
+	return cast(int) _collection_serialize(collection, raw_data(buffer), cast(u64) len(buffer))
+}
+
+scene_serialize :: proc(scene : Scene, shared : Collection, buffer : []byte) -> int {
+	return cast(int) _scene_serialize(scene, shared, raw_data(buffer), cast(u64) len(buffer))
+}
+
+scene_deserialize :: proc(scene : Scene, shared : Collection, buffer_128_byte_aligned : []byte, actors_out : []Actor = nil) -> int {
+	return cast(int) _scene_deserialize(scene, shared, raw_data(buffer_128_byte_aligned), raw_data(actors_out), cast(u32) len(actors_out))
+}
+
+scene_save_state :: proc(scene : Scene, states_out : []Actor_State) -> int {
+	return cast(int) _scene_save_state(scene, raw_data(states_out), cast(u32) len(states_out))
+}
+
+actors_restore_state :: proc(states : []Actor_State) {
+	_actors_restore_state(raw_data(states), cast(u32) len(states))
+}
+
+// Static actors never move and don't pay for mass, velocity or sleep state. All actor_* procs accept them,
+// dynamic-only operations are ignored.
+actor_create_static :: proc(transform : Transform, shapes : []Shape_Description) -> Actor {
+	return _actor_create_static(transform, raw_data(shapes), cast(u32) len(shapes))
+}
+
+// Creates actors with all their shapes, computing mass once per actor
+actors_create_batch :: proc(descriptions : []Actor_Description, actors_out : []Actor) {
+	assert(len(actors_out) >= len(descriptions))
+	_actors_create_batch(raw_data(descriptions), cast(u32) len(descriptions), raw_data(actors_out))
+}
+
+scene_add_actors :: proc(scene : Scene, actors : []Actor) {
+	_scene_add_actors(scene, raw_data(actors), cast(u32) len(actors))
+}
+
+pruning_structure_create :: proc(actors : []Actor) -> Pruning_Structure {
+	return _pruning_structure_create(raw_data(actors), cast(u32) len(actors))
+}
+
+cook_triangle_meshes :: proc(mesh_descriptions : []Mesh_Description, buffers_out : []Buffer, options : Cooking_Options = {}) {
+	assert(len(buffers_out) >= len(mesh_descriptions))
+	_cook_triangle_meshes(raw_data(mesh_descriptions), cast(u32) len(mesh_descriptions), options, raw_data(buffers_out))
+}
+
+cook_convex_meshes :: proc(mesh_descriptions : []Mesh_Description, buffers_out : []Buffer, options : Cooking_Options = {}) {
+	assert(len(buffers_out) >= len(mesh_descriptions))
+	_cook_convex_meshes(raw_data(mesh_descriptions), cast(u32) len(mesh_descriptions), options, raw_data(buffers_out))
+}
+
+allocator_get_sites :: proc(sites_out : []Allocation_Site) -> int {
+	return cast(int) _allocator_get_sites(raw_data(sites_out), cast(u32) len(sites_out))
+}
+
+mesh_archive_pack :: proc(buffers : []Buffer, types : []Mesh_Type) -> Buffer {
+	assert(len(types) >= len(buffers))
+	return _mesh_archive_pack(raw_data(buffers), raw_data(types), cast(u32) len(buffers))
+}
+
+mesh_archive_load :: proc(archive : []byte, meshes_out : []Archive_Mesh) -> int {
+	return cast(int) _mesh_archive_load(raw_data(archive), cast(u64) len(archive), raw_data(meshes_out), cast(u32) len(meshes_out))
+}
+
+mesh_archive_load_file :: proc(path : cstring, meshes_out : []Archive_Mesh) -> int {
+	return cast(int) _mesh_archive_load_file(path, raw_data(meshes_out), cast(u32) len(meshes_out))
+}
+
+actors_set_transforms :: proc(actors : []Actor, transforms : []Transform) {
+	assert(len(transforms) >= len(actors))
+	_actors_set_transforms(raw_data(actors), raw_data(transforms), size_of(Transform), cast(u32) len(actors))
+}
+
+actors_set_kinematic_targets :: proc(actors : []Actor, transforms : []Transform) {
+	assert(len(transforms) >= len(actors))
+	_actors_set_kinematic_targets(raw_data(actors), raw_data(transforms), size_of(Transform), cast(u32) len(actors))
+}
+
+actors_set_velocities :: proc(actors : []Actor, velocities : []linalg.Vector3f32) {
+	assert(len(velocities) >= len(actors))
+	_actors_set_velocities(raw_data(actors), raw_data(velocities), size_of(linalg.Vector3f32), cast(u32) len(actors))
+}
+
+controllers_move_batch :: proc(controllers : []Controller, displacements : []linalg.Vector3f32, mask_indices : []u32, dt : f32, parallel_cell_size : f32 = 0, collision_flags_out : []Controller_Collision_Flags = nil, positions_out : []linalg.Vector3f32 = nil) {
+	count := len(controllers)
+	assert(len(displacements) >= count && len(mask_indices) >= count)
+	assert(collision_flags_out == nil || len(collision_flags_out) >= count)
+	assert(positions_out == nil || len(positions_out) >= count)
+	_controllers_move_batch(raw_data(controllers), raw_data(displacements), raw_data(mask_indices), cast(u32) count, dt, parallel_cell_size, raw_data(collision_flags_out), raw_data(positions_out))
+}
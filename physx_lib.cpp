@@ -5,6 +5,22 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <assert.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #define PVD_HOST "127.0.0.1"	//Set this to the IP address of the system running the PhysX Visual Debugger that you want to connect to.
 
@@ -16,6 +32,16 @@ PxPhysics* gPhysics	= nullptr;
 PxDefaultCpuDispatcher* gDispatcher = nullptr;
 PxPvd* gPvd = nullptr;
 PxCooking* gCooking	= nullptr;
+PxSerializationRegistry* gSerializationRegistry = nullptr;
+
+// Zero initialized transforms in descriptions are treated as identity
+PxTransform to_px_pose(Px_Transform t) {
+	PxTransform pose = *(PxTransform*) &t;
+	if(pose.q.magnitudeSquared() == 0.0f) {
+		pose.q = PxQuat(PxIdentity);
+	}
+	return pose;
+}
 
 Px_Vector3f32 to_vec(PxVec3 v) {
 	return *(Px_Vector3f32*) &v;
@@ -25,27 +51,195 @@ PxVec3 to_px(Px_Vector3f32 v) {
 	return *(PxVec3*) &v;
 }
 
+#define NUM_SIZE_CLASSES 7 // 16 to 1024 bytes
+#define NO_SIZE_CLASS 0xffff
+#define POOL_CHUNK_SIZE (64 * 1024)
+#define MAX_ALLOCATION_SITES 1024
+
+// Prepended to every allocation when tracking or pooling is enabled, keeps the payload 16 byte aligned
+struct Allocation_Header {
+	uint64_t size;
+	uint32_t site;
+	uint16_t size_class;
+	uint16_t padding;
+};
+
+// Accounting for one type_name/filename pair
+struct Allocation_Site {
+	std::atomic<uint64_t> key{0};
+	char const* type_name = nullptr;
+	char const* filename = nullptr;
+	std::atomic<uint64_t> bytes{0};
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> total_count{0};
+};
+
+// Fixed size blocks carved from chunks of the backing allocator. Chunks are kept until px_destroy.
+struct Size_Class_Pool {
+	std::mutex mutex;
+	void* free_list = nullptr;
+	void* chunks = nullptr;
+	uint64_t reserved_bytes = 0;
+};
+
 class Allocator_Callback : public PxAllocatorCallback
 {
 public:
 	Allocator_Callback() {}
 
-	Allocator_Callback(Px_Allocator allocator)
-		: allocator(allocator) {
-	}
 	virtual ~Allocator_Callback()
 	{
 	}
 
+	void init(Px_Allocator px_allocator) {
+		allocator = px_allocator;
+		use_header = allocator.track_allocations || allocator.pool_small_allocations;
+	}
+
 	virtual void* allocate(size_t size, const char* type_name, const char* filename, int line) override {
-		return allocator.allocate_16_byte_aligned(&allocator, size, filename, line);
+		if(!use_header) {
+			return allocator.allocate_16_byte_aligned(&allocator, size, filename, line);
+		}
+
+		Allocation_Header* header = nullptr;
+		uint16_t size_class = allocator.pool_small_allocations ? get_size_class(size) : NO_SIZE_CLASS;
+		if(size_class != NO_SIZE_CLASS) {
+			header = (Allocation_Header*) pool_allocate(size_class);
+		}
+		else {
+			header = (Allocation_Header*) allocator.allocate_16_byte_aligned(&allocator, sizeof(Allocation_Header) + size, filename, line);
+		}
+		if(!header) {
+			return nullptr;
+		}
+		header->size = size;
+		header->size_class = size_class;
+		header->site = allocator.track_allocations ? track_allocate(size, type_name, filename) : 0;
+		return header + 1;
 	}
 
 	virtual void deallocate(void* ptr) {
-		allocator.deallocate(&allocator, ptr);
+		if(!use_header) {
+			allocator.deallocate(&allocator, ptr);
+			return;
+		}
+		if(!ptr) {
+			return;
+		}
+
+		Allocation_Header* header = (Allocation_Header*) ptr - 1;
+		if(allocator.track_allocations) {
+			Allocation_Site& site = sites[header->site];
+			site.bytes -= header->size;
+			site.count--;
+			bytes -= header->size;
+			count--;
+		}
+		if(header->size_class != NO_SIZE_CLASS) {
+			pool_deallocate(header->size_class, header);
+		}
+		else {
+			allocator.deallocate(&allocator, header);
+		}
+	}
+
+	static uint16_t get_size_class(size_t size) {
+		for(uint16_t size_class = 0; size_class < NUM_SIZE_CLASSES; ++size_class) {
+			if(size <= (16u << size_class)) {
+				return size_class;
+			}
+		}
+		return NO_SIZE_CLASS;
+	}
+
+	void* pool_allocate(uint16_t size_class) {
+		Size_Class_Pool& pool = pools[size_class];
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		if(!pool.free_list) {
+			// First 16 bytes of a chunk link the chunks together, the rest is split into blocks
+			uint8_t* chunk = (uint8_t*) allocator.allocate_16_byte_aligned(&allocator, POOL_CHUNK_SIZE, __FILE__, __LINE__);
+			if(!chunk) {
+				return nullptr;
+			}
+			*(void**) chunk = pool.chunks;
+			pool.chunks = chunk;
+			pool.reserved_bytes += POOL_CHUNK_SIZE;
+
+			size_t block_size = sizeof(Allocation_Header) + (16u << size_class);
+			for(size_t offset = 16; offset + block_size <= POOL_CHUNK_SIZE; offset += block_size) {
+				*(void**) (chunk + offset) = pool.free_list;
+				pool.free_list = chunk + offset;
+			}
+		}
+		void* block = pool.free_list;
+		pool.free_list = *(void**) block;
+		return block;
+	}
+
+	void pool_deallocate(uint16_t size_class, void* block) {
+		Size_Class_Pool& pool = pools[size_class];
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		*(void**) block = pool.free_list;
+		pool.free_list = block;
+	}
+
+	// Returns the pool chunks to the backing allocator, only once nothing allocated from them is alive
+	void release_pools() {
+		for(Size_Class_Pool& pool : pools) {
+			while(pool.chunks) {
+				void* next = *(void**) pool.chunks;
+				allocator.deallocate(&allocator, pool.chunks);
+				pool.chunks = next;
+			}
+			pool.free_list = nullptr;
+			pool.reserved_bytes = 0;
+		}
+	}
+
+	uint32_t track_allocate(size_t size, const char* type_name, const char* filename) {
+		// Names are literals, so their addresses identify the site without hashing the strings
+		uint64_t key = ((uint64_t) (uintptr_t) type_name * 0x9e3779b97f4a7c15ull) ^ (uint64_t) (uintptr_t) filename;
+		key = key ? key : 1;
+		uint32_t index = (uint32_t) (key >> 32) % MAX_ALLOCATION_SITES;
+		for(uint32_t probe = 0; probe < MAX_ALLOCATION_SITES; ++probe, index = (index + 1) % MAX_ALLOCATION_SITES) {
+			uint64_t expected = sites[index].key;
+			if(expected == 0 && sites[index].key.compare_exchange_strong(expected, key)) {
+				sites[index].type_name = type_name;
+				sites[index].filename = filename;
+				num_sites++;
+			}
+			if(expected == key || expected == 0) {
+				break;
+			}
+		}
+
+		// When the table is full the last probed site takes the allocation
+		Allocation_Site& site = sites[index];
+		site.bytes += size;
+		site.count++;
+		site.total_count++;
+
+		uint64_t new_bytes = bytes += size;
+		uint64_t current_peak = peak_bytes;
+		while(new_bytes > current_peak && !peak_bytes.compare_exchange_weak(current_peak, new_bytes)) {}
+		count++;
+		total_count++;
+		frame_count++;
+		return index;
 	}
 
 	Px_Allocator allocator;
+	bool use_header = false;
+
+	Size_Class_Pool pools[NUM_SIZE_CLASSES];
+
+	Allocation_Site sites[MAX_ALLOCATION_SITES];
+	std::atomic<uint32_t> num_sites{0};
+	std::atomic<uint64_t> bytes{0};
+	std::atomic<uint64_t> peak_bytes{0};
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> total_count{0};
+	std::atomic<uint64_t> frame_count{0};
 };
 Allocator_Callback gAllocator;
 
@@ -60,13 +254,47 @@ uint32_t next_power_of_two(uint32_t x)
 	return x + 1;
 }
 
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+
+// FNV-1a, pass the previous result to continue hashing
+uint64_t hash_bytes(void const* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS) {
+	uint8_t const* bytes = (uint8_t const*) data;
+	for(size_t i = 0; i < size; ++i) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+double now_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Adds the time spent in the scope to total_ms, when enabled
+struct Scoped_Timer {
+	Scoped_Timer(float& total_ms, bool enabled = true) : total_ms(total_ms), start(enabled ? now_ms() : -1.0) {}
+	~Scoped_Timer() {
+		if(start >= 0.0) {
+			total_ms += (float) (now_ms() - start);
+		}
+	}
+
+	float& total_ms;
+	double start;
+};
+
+// Event callbacks run once per pair header, so they are only timed while the profiler is enabled
+bool gTimeEventCollection = false;
+
 class DefaultMemoryOutputStream : public PxOutputStream {
 public:
-	DefaultMemoryOutputStream(PxAllocatorCallback &allocator = PxGetFoundation().getAllocatorCallback()) 
+	DefaultMemoryOutputStream(PxU32 initialCapacity = 0, PxAllocatorCallback &allocator = PxGetFoundation().getAllocatorCallback()) 
 		: mAllocator(allocator)
 		, mData(0)
 		, mSize(0)
 		, mCapacity(0) {
+		if(initialCapacity) {
+			reserve(initialCapacity);
+		}
 	}
 
 	virtual ~DefaultMemoryOutputStream() {
@@ -77,22 +305,28 @@ public:
 		PxU32 expectedSize = mSize + size;
 		if(expectedSize > mCapacity)
 		{
-			mCapacity = PxMax(next_power_of_two(expectedSize), 4096u);
-
-			PxU8* newData = reinterpret_cast<PxU8*>(mAllocator.allocate(mCapacity,"PxDefaultMemoryOutputStream",__FILE__,__LINE__));
-			PX_ASSERT(newData!=NULL);
-
-			PxMemCopy(newData, mData, mSize);
-			if(mData)
-				mAllocator.deallocate(mData);
-
-			mData = newData;
+			reserve(PxMax(next_power_of_two(expectedSize), 4096u));
 		}
 		PxMemCopy(mData+mSize, src, size);
 		mSize += size;
 		return size;
 	}
 
+	void reserve(PxU32 capacity) {
+		if(capacity <= mCapacity)
+			return;
+		mCapacity = capacity;
+
+		PxU8* newData = reinterpret_cast<PxU8*>(mAllocator.allocate(mCapacity,"PxDefaultMemoryOutputStream",__FILE__,__LINE__));
+		PX_ASSERT(newData!=NULL);
+
+		PxMemCopy(newData, mData, mSize);
+		if(mData)
+			mAllocator.deallocate(mData);
+
+		mData = newData;
+	}
+
 	virtual	PxU32 getSize()	const {
 		return mSize;
 	}
@@ -146,20 +380,114 @@ private:
 	PxU32		mPos;
 };
 
+// Splits [0, count) into chunks that are processed by the calling thread and the dispatcher's workers.
+// Blocks until all chunks are done, so must not be called from inside a dispatcher task.
+class Parallel_For {
+public:
+	typedef void (*Function)(void* context, uint32_t begin, uint32_t end);
+
+	class Task : public PxBaseTask {
+	public:
+		virtual void run() override {
+			parallel_for->run_chunks();
+		}
+		virtual void release() override {
+			parallel_for->task_done();
+		}
+		virtual const char* getName() const override {
+			return "px_parallel_for";
+		}
+		virtual void addReference() override {}
+		virtual void removeReference() override {}
+		virtual int32_t getReference() const override {
+			return 1;
+		}
+
+		Parallel_For* parallel_for = nullptr;
+	};
+
+	#define MAX_PARALLEL_TASKS 64
+
+	Parallel_For(PxCpuDispatcher* dispatcher, uint32_t count, uint32_t chunk_size, Function function, void* context)
+		: function(function)
+		, context(context)
+		, count(count)
+		, chunk_size(PxMax(chunk_size, 1u))
+		, next(0)
+		, pending_tasks(0) {
+
+		uint32_t num_chunks = (count + this->chunk_size - 1) / this->chunk_size;
+		uint32_t num_tasks = dispatcher ? PxMin(PxMin(dispatcher->getWorkerCount(), num_chunks - PxMin(num_chunks, 1u)), (uint32_t) MAX_PARALLEL_TASKS) : 0;
+		pending_tasks = num_tasks;
+		for(uint32_t i = 0; i < num_tasks; ++i) {
+			tasks[i].parallel_for = this;
+			dispatcher->submitTask(tasks[i]);
+		}
+
+		run_chunks();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this] { return pending_tasks.load() == 0; });
+	}
+
+private:
+	void run_chunks() {
+		for(;;) {
+			uint32_t begin = next.fetch_add(chunk_size);
+			if(begin >= count) {
+				return;
+			}
+			function(context, begin, PxMin(begin + chunk_size, count));
+		}
+	}
+
+	void task_done() {
+		std::lock_guard<std::mutex> lock(mutex);
+		if(--pending_tasks == 0) {
+			done.notify_one();
+		}
+	}
+
+	Function function;
+	void* context;
+	uint32_t count;
+	uint32_t chunk_size;
+	std::atomic<uint32_t> next;
+	std::atomic<uint32_t> pending_tasks;
+	std::mutex mutex;
+	std::condition_variable done;
+	Task tasks[MAX_PARALLEL_TASKS];
+};
+
+template<typename Fn>
+void parallel_for(PxCpuDispatcher* dispatcher, uint32_t count, uint32_t chunk_size, Fn const& fn) {
+	Parallel_For::Function thunk = [](void* context, uint32_t begin, uint32_t end) {
+		(*(Fn const*) context)(begin, end);
+	};
+	Parallel_For parallel(dispatcher, count, chunk_size, thunk, (void*) &fn);
+}
+
 #define NUM_GROUPS 64
 typedef uint64_t Collision_Masks[NUM_GROUPS];
-Collision_Masks collision_masks;
+
+// Copied by PhysX into the scene, see PxSceneDesc::filterShaderData
+struct Filter_Shader_Data {
+	Collision_Masks collision_masks;
+	uint64_t ccd_layers; // Pairs touching one of these layers get swept CCD contacts
+	bool export_contact_points;
+};
 
 PxFilterFlags CollisionFilterShader(
     PxFilterObjectAttributes attributes0, PxFilterData filterData0,
     PxFilterObjectAttributes attributes1, PxFilterData filterData1,
     PxPairFlags& pairFlags, const void* constantBlock, PxU32 constantBlockSize)
 {
-	// TODO: for per scene masks rather than global store in constantBlock
-	// collision_masks = *(Collision_Masks const&) constantBlock;
+	assert(constantBlockSize == sizeof(Filter_Shader_Data));
+	Filter_Shader_Data const& filter_shader_data = *(Filter_Shader_Data const*) constantBlock;
+	Collision_Masks const& collision_masks = filter_shader_data.collision_masks;
 
-	if(((1 << filterData0.word0) & collision_masks[filterData1.word1]) != 0 ||
-		((1 << filterData1.word0) & collision_masks[filterData0.word1]) != 0) {
+	if(((1ull << filterData0.word0) & collision_masks[filterData1.word1]) != 0 ||
+		((1ull << filterData1.word0) & collision_masks[filterData0.word1]) != 0) {
 
 		if(PxFilterObjectIsTrigger(attributes0) || PxFilterObjectIsTrigger(attributes1)) {
 			pairFlags = PxPairFlag::eTRIGGER_DEFAULT;
@@ -168,6 +496,13 @@ PxFilterFlags CollisionFilterShader(
 			pairFlags = PxPairFlag::eCONTACT_DEFAULT;
 			pairFlags |= PxPairFlag::eNOTIFY_TOUCH_FOUND;
 			pairFlags |= PxPairFlag::eNOTIFY_CONTACT_POINTS;
+			if(((1ull << filterData0.word0) | (1ull << filterData1.word0)) & filter_shader_data.ccd_layers) {
+				pairFlags |= PxPairFlag::eDETECT_CCD_CONTACT;
+			}
+			if(filter_shader_data.export_contact_points) {
+				pairFlags |= PxPairFlag::eNOTIFY_TOUCH_PERSISTS;
+				pairFlags |= PxPairFlag::eNOTIFY_TOUCH_LOST;
+			}
 		}
 	}
 	else {
@@ -177,30 +512,197 @@ PxFilterFlags CollisionFilterShader(
     return PxFilterFlag::eDEFAULT;
 }
 
+#define DEFAULT_EVENT_CAPACITY 256
+
+// Growable array for POD event data. Memory comes from gAllocator and is kept between steps,
+// so once the capacity has settled no allocations happen.
+template<typename T>
+class Event_Buffer {
+public:
+	~Event_Buffer() {
+		if(data) {
+			gAllocator.deallocate(data);
+		}
+	}
+
+	bool reserve(uint32_t new_capacity) {
+		if(new_capacity <= capacity) {
+			return true;
+		}
+		T* new_data = (T*) gAllocator.allocate(sizeof(T) * new_capacity, "Event_Buffer", __FILE__, __LINE__);
+		if(!new_data) {
+			return false;
+		}
+		if(data) {
+			PxMemCopy(new_data, data, sizeof(T) * size);
+			gAllocator.deallocate(data);
+		}
+		data = new_data;
+		capacity = new_capacity;
+		return true;
+	}
+
+	// Returns count contiguous elements, or nullptr and counts them as dropped if the buffer can't grow
+	T* push(uint32_t count = 1) {
+		if(size + count > capacity) {
+			uint32_t new_capacity = PxMax(next_power_of_two(size + count), 16u);
+			if(max_capacity) {
+				new_capacity = PxMin(new_capacity, max_capacity);
+			}
+			if(new_capacity < size + count || !reserve(new_capacity)) {
+				dropped += count;
+				return nullptr;
+			}
+		}
+		T* result = &data[size];
+		size += count;
+		return result;
+	}
+
+	void clear() {
+		size = 0;
+		dropped = 0;
+	}
+
+	T* data = nullptr;
+	uint32_t size = 0;
+	uint32_t capacity = 0;
+	uint32_t max_capacity = 0; // 0 for unbounded
+	uint32_t dropped = 0;
+};
+
+// Poses from onAdvance, published in order so readers on other threads always see a fully written prefix.
+// onAdvance can run on several worker threads at once.
+class Pose_Preview_Buffer {
+public:
+	~Pose_Preview_Buffer() {
+		if(data) {
+			gAllocator.deallocate(data);
+		}
+	}
+
+	void init(uint32_t new_capacity) {
+		// Entries and their sequence numbers share one allocation, entries first so data can be handed out as is
+		data = (Px_Pose_Preview*) gAllocator.allocate((sizeof(Px_Pose_Preview) + sizeof(std::atomic<uint32_t>)) * new_capacity, "Pose_Preview_Buffer", __FILE__, __LINE__);
+		capacity = data ? new_capacity : 0;
+		sequences = (std::atomic<uint32_t>*) (data + capacity);
+		for(uint32_t i = 0; i < capacity; ++i) {
+			new (&sequences[i]) std::atomic<uint32_t>(0);
+		}
+	}
+
+	// Only while the scene isn't simulating. Bumping the generation invalidates all entries at once.
+	void clear() {
+		if(++generation == 0) {
+			generation = 1;
+		}
+		reserved = 0;
+		dropped = 0;
+	}
+
+	// Lock free, writers never wait on each other
+	void push(const PxRigidBody*const* bodies, const PxTransform* poses, uint32_t count) {
+		uint32_t start = reserved.fetch_add(count);
+		uint32_t num_written = start < capacity ? PxMin(count, capacity - start) : 0;
+		for(uint32_t i = 0; i < num_written; ++i) {
+			data[start + i].actor = (Px_Actor) bodies[i];
+			data[start + i].transform = *(Px_Transform*) &poses[i];
+			sequences[start + i].store(generation, std::memory_order_release);
+		}
+		dropped += count - num_written;
+	}
+
+	// Length of the prefix of entries written during the current step
+	uint32_t size() const {
+		uint32_t limit = PxMin(reserved.load(std::memory_order_acquire), capacity);
+		uint32_t count = 0;
+		while(count < limit && sequences[count].load(std::memory_order_acquire) == generation) {
+			++count;
+		}
+		return count;
+	}
+
+	Px_Pose_Preview* data = nullptr;
+	std::atomic<uint32_t>* sequences = nullptr;
+	uint32_t capacity = 0;
+	uint32_t generation = 1;
+	std::atomic<uint32_t> reserved{0};
+	std::atomic<uint32_t> dropped{0};
+};
+
 class SimulationEventCallback : public PxSimulationEventCallback {
 public:
+	SimulationEventCallback(uint32_t initial_capacity, uint32_t max_capacity, uint32_t pose_preview_capacity, bool export_contact_points)
+		: export_contact_points(export_contact_points) {
+		pose_previews.init(pose_preview_capacity);
+		if(max_capacity) {
+			initial_capacity = PxMin(initial_capacity, max_capacity);
+		}
+		contacts.max_capacity = max_capacity;
+		contact_pairs.max_capacity = max_capacity;
+		contact_points.max_capacity = max_capacity;
+		triggers.max_capacity = max_capacity;
+		woken_actors.max_capacity = max_capacity;
+		sleeping_actors.max_capacity = max_capacity;
+		if(export_contact_points) {
+			contact_pairs.reserve(initial_capacity);
+			contact_points.reserve(initial_capacity);
+		}
+		else {
+			contacts.reserve(initial_capacity);
+		}
+		triggers.reserve(initial_capacity);
+	}
 
-	// TODO: Init setting
-	#define MAX_NOTIFY 256
-	Px_Contact touch[MAX_NOTIFY];
-	int numTouch = 0;
+	void clear() {
+		contacts.clear();
+		contact_pairs.clear();
+		contact_points.clear();
+		triggers.clear();
+		woken_actors.clear();
+		sleeping_actors.clear();
+		collection_ms = 0.0f;
+	}
 
-	Px_Trigger triggers[MAX_NOTIFY];
-	int numTrigger = 0;
+	bool export_contact_points;
+	Event_Buffer<Px_Contact> contacts;
+	Event_Buffer<Px_Contact_Pair> contact_pairs;
+	Event_Buffer<Px_Contact_Point> contact_points;
+	Event_Buffer<Px_Trigger> triggers;
+	Event_Buffer<Px_Actor> woken_actors;
+	Event_Buffer<Px_Actor> sleeping_actors;
+	Pose_Preview_Buffer pose_previews;
+	// Time spent in the callbacks since the last clear
+	float collection_ms = 0.0f;
 
 	void onConstraintBreak(PxConstraintInfo* constraints, PxU32 count) {}
-	void onWake(PxActor** actors, PxU32 count) {}
-	void onSleep(PxActor** actors, PxU32 count) {}
-	void onAdvance(const PxRigidBody*const* bodyBuffer, const PxTransform* poseBuffer, const PxU32 count) {}
+	void onWake(PxActor** actors, PxU32 count) override {
+		Scoped_Timer timer(collection_ms, gTimeEventCollection);
+		Px_Actor* events = woken_actors.push(count);
+		if(events) {
+			PxMemCopy(events, actors, sizeof(PxActor*) * count);
+		}
+	}
+
+	void onSleep(PxActor** actors, PxU32 count) override {
+		Scoped_Timer timer(collection_ms, gTimeEventCollection);
+		Px_Actor* events = sleeping_actors.push(count);
+		if(events) {
+			PxMemCopy(events, actors, sizeof(PxActor*) * count);
+		}
+	}
+	void onAdvance(const PxRigidBody*const* bodyBuffer, const PxTransform* poseBuffer, const PxU32 count) override {
+		pose_previews.push(bodyBuffer, poseBuffer, count);
+	}
 	void onContact(const PxContactPairHeader& pairHeader, const PxContactPair* pairs, PxU32 nbPairs) override
 	{	
+		Scoped_Timer timer(collection_ms, gTimeEventCollection);
 		if(pairHeader.flags & (PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | PxContactPairHeaderFlag::eREMOVED_ACTOR_1) )
 		{
 			return;
 		}
-		if(numTouch >= MAX_NOTIFY)
-		{
-			printf("Too many contacts, discarding the rest\n");
+		if(export_contact_points) {
+			add_contact_pairs(pairHeader, pairs, nbPairs);
 			return;
 		}
 
@@ -208,6 +710,7 @@ public:
 		PxVec3 normal(PxZero);
 		PxVec3 impulse(PxZero);
 		float separation = 0.0f;
+		bool touching = false;
 		for(PxU32 i=0; i < nbPairs; i++)
 		{
 			const PxContactPair& cp = pairs[i];
@@ -215,6 +718,7 @@ public:
 			if(cp.events & PxPairFlag::eNOTIFY_TOUCH_FOUND || 
 				cp.events & PxPairFlag::eNOTIFY_TOUCH_PERSISTS)
 			{
+				touching = true;
 				PxContactPairPoint ContactPointBuffer[16];
 				int32_t NumContactPoints = cp.extractContacts(ContactPointBuffer, 16);
 				// Use first contact point as collision posiion
@@ -234,23 +738,67 @@ public:
 				}	
 			}
 		}
-		Px_Contact& contact = touch[numTouch++];
-		contact.actor0 = pairHeader.actors[0];
-		contact.actor1 = pairHeader.actors[1];
-		contact.pos = to_vec(pos);
-		contact.normal = to_vec(normal);
-		contact.impulse = to_vec(impulse);
+		if(!touching) {
+			return;
+		}
+		Px_Contact* contact = contacts.push();
+		if(!contact) {
+			return;
+		}
+		contact->actor0 = pairHeader.actors[0];
+		contact->actor1 = pairHeader.actors[1];
+		contact->pos = to_vec(pos);
+		contact->normal = to_vec(normal);
+		contact->impulse = to_vec(impulse);
 	}
 
-	void onTrigger(PxTriggerPair* pairs, PxU32 count) override
+	// Writes every contact point straight into the pooled point array
+	void add_contact_pairs(const PxContactPairHeader& pairHeader, const PxContactPair* pairs, PxU32 nbPairs)
 	{
-		for(PxU32 i=0; i < count; i++)
+		static_assert(sizeof(Px_Contact_Point) == sizeof(PxContactPairPoint), "Px_Contact_Point must match PxContactPairPoint");
+
+		for(PxU32 i=0; i < nbPairs; i++)
 		{
-			if(numTrigger >= MAX_NOTIFY)
-			{
-				printf("Too many trigger events, discarding the rest\n");
+			const PxContactPair& cp = pairs[i];
+			if(cp.flags & (PxContactPairFlag::eREMOVED_SHAPE_0 | PxContactPairFlag::eREMOVED_SHAPE_1)) {
+				continue;
+			}
+
+			Px_Contact_State state = eCONTACT_TOUCH_PERSISTS;
+			if(cp.events & PxPairFlag::eNOTIFY_TOUCH_FOUND) {
+				state = eCONTACT_TOUCH_FOUND;
+			}
+			if(cp.events & PxPairFlag::eNOTIFY_TOUCH_LOST) {
+				state = eCONTACT_TOUCH_LOST;
+			}
+
+			Px_Contact_Pair* pair = contact_pairs.push();
+			if(!pair) {
 				return;
 			}
+			pair->actor0 = pairHeader.actors[0];
+			pair->actor1 = pairHeader.actors[1];
+			pair->shape0 = cp.shapes[0];
+			pair->shape1 = cp.shapes[1];
+			pair->state = state;
+			pair->first_point = contact_points.size;
+			pair->num_points = 0;
+
+			if(cp.contactCount > 0) {
+				Px_Contact_Point* points = contact_points.push(cp.contactCount);
+				if(points) {
+					pair->num_points = cp.extractContacts((PxContactPairPoint*) points, cp.contactCount);
+					contact_points.size = pair->first_point + pair->num_points;
+				}
+			}
+		}
+	}
+
+	void onTrigger(PxTriggerPair* pairs, PxU32 count) override
+	{
+		Scoped_Timer timer(collection_ms, gTimeEventCollection);
+		for(PxU32 i=0; i < count; i++)
+		{
 			// ignore pairs when shapes have been deleted
 			if (pairs[i].flags & (PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | PxTriggerPairFlag::eREMOVED_SHAPE_OTHER))
 				continue;
@@ -262,107 +810,776 @@ public:
 			if(pairs[i].status & PxPairFlag::eNOTIFY_TOUCH_LOST) {
 				state = eNOTIFY_TOUCH_LOST;
 			}
-			fflush(stdout);
 
-			Px_Trigger& trigger = triggers[numTrigger++];
-			trigger.trigger = pairs[i].triggerActor;
-			trigger.other_actor = pairs[i].otherActor;
-			trigger.state = state;
+			Px_Trigger* trigger = triggers.push();
+			if(!trigger) {
+				continue;
+			}
+			trigger->trigger = pairs[i].triggerActor;
+			trigger->other_actor = pairs[i].otherActor;
+			trigger->state = state;
 		}
 	}
 };
 
-void px_init(Px_Allocator allocator, bool initialize_cooking, bool initialize_pvd) {
-	gAllocator = Allocator_Callback(allocator);
-	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+class Simulation_Complete_Task : public PxLightCpuTask {
+public:
+	virtual void run() override {
+		if(callback) {
+			callback(scene, user_data);
+		}
+	}
 
-	if(initialize_pvd) {
-		gPvd = PxCreatePvd(*gFoundation);
-		PxPvdTransport* transport = PxDefaultPvdSocketTransportCreate(PVD_HOST, 5425, 10);
-		gPvd->connect(*transport, PxPvdInstrumentationFlag::eALL);
+	virtual const char* getName() const override {
+		return "px_simulation_complete";
 	}
 
-	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale(), false, gPvd);
-	PxInitExtensions(*gPhysics, gPvd);
+	Px_Scene scene = nullptr;
+	Px_Simulation_Complete_Callback callback = nullptr;
+	void* user_data = nullptr;
+};
 
-	if(initialize_cooking) {
-		gCooking = PxCreateCooking(PX_PHYSICS_VERSION, *gFoundation, PxCookingParams(PxTolerancesScale()));
-	}
+struct Previous_Pose {
+	PxRigidActor* actor;
+	PxTransform pose;
+};
 
-	gDispatcher = PxDefaultCpuDispatcherCreate(4);
+// Stored in PxScene::userData
+class Scene_Data {
+public:
+	PxControllerManager* controller_manager = nullptr;
+	Simulation_Complete_Task complete_task;
+	bool simulating = false;
+
+	// Masks used by queries and controllers right away. The filter shader gets its own copy,
+	// which is only updated between steps.
+	Filter_Shader_Data filter_shader_data;
+	uint64_t dirty_mask_indices = 0;
+	uint64_t dirty_ccd_layers = 0;
+
+	// Fixed step mode when fixed_step > 0
+	float fixed_step = 0.0f;
+	uint32_t max_substeps = 0;
+	float accumulator = 0.0f;
+	float interpolation_alpha = 1.0f;
+	// Poses of the actors active going into the last substep, sorted by actor. Only kept once
+	// px_scene_read_active_transforms_interpolated has been called.
+	bool keep_previous_poses = false;
+	Event_Buffer<Previous_Pose> previous_poses;
+
+	// Current call to px_scene_simulate_begin/end
+	float step_dt = 0.0f;
+	uint32_t remaining_substeps = 0;
+	void* scratch_memory = nullptr;
+	size_t scratch_size = 0;
+
+	// Timings of the last px_scene_simulate_begin/end, see Px_Scene_Stats
+	float simulate_ms = 0.0f;
+	float fetch_results_ms = 0.0f;
+	uint32_t num_substeps = 0;
+	// Controller moves since the last px_scene_simulate_begin, and those before it
+	float controller_move_ms = 0.0f;
+	float last_controller_move_ms = 0.0f;
+};
 
-	for(int i = 0; i < NUM_GROUPS; ++i) {
-		// Collide against all groups by Default
-		collision_masks[i] = UINT64_MAX;
-	}
+Scene_Data* get_scene_data(PxScene* scene) {
+	return (Scene_Data*) scene->userData;
 }
 
-void px_destroy() {
-	PxCloseExtensions();
-	gDispatcher->release();
-	if(gCooking) {
-		gCooking->release();
+// Stored in PxController::userData
+class Controller_Data {
+public:
+	float min_distance = 0.0f;
+	PxObstacleContext* obstacle_context = nullptr;
+};
+
+Controller_Data* get_controller_data(PxController* controller) {
+	return (Controller_Data*) controller->getUserData();
+}
+
+// Pushes changed masks and CCD layers to the filter shader and refilters only the shapes they affect
+void apply_collision_masks(PxScene* scene, Scene_Data* scene_data) {
+	if(!scene_data->dirty_mask_indices && !scene_data->dirty_ccd_layers) {
+		return;
 	}
-	gPhysics->release();
-	if(gPvd)
-	{
-		PxPvdTransport* transport = gPvd->getTransport();
-		gPvd->release();
-		gPvd = nullptr;
-		if(transport) {
-			transport->release();
+	scene->setFilterShaderData(&scene_data->filter_shader_data, sizeof(Filter_Shader_Data));
+
+	#define REFILTER_BATCH_SIZE 64
+	PxActorTypeFlags actor_types = PxActorTypeFlag::eRIGID_DYNAMIC | PxActorTypeFlag::eRIGID_STATIC;
+	PxU32 num_actors = scene->getNbActors(actor_types);
+	PxActor* actors[REFILTER_BATCH_SIZE];
+	PxShape* shapes[REFILTER_BATCH_SIZE];
+	PxShape* affected_shapes[REFILTER_BATCH_SIZE];
+	for(PxU32 actor_start = 0; actor_start < num_actors; actor_start += REFILTER_BATCH_SIZE) {
+		PxU32 num_fetched_actors = scene->getActors(actor_types, actors, REFILTER_BATCH_SIZE, actor_start);
+		for(PxU32 i = 0; i < num_fetched_actors; ++i) {
+			PxRigidActor* actor = (PxRigidActor*) actors[i];
+			PxU32 num_shapes = actor->getNbShapes();
+			for(PxU32 shape_start = 0; shape_start < num_shapes; shape_start += REFILTER_BATCH_SIZE) {
+				PxU32 num_fetched_shapes = actor->getShapes(shapes, REFILTER_BATCH_SIZE, shape_start);
+				PxU32 num_affected = 0;
+				for(PxU32 j = 0; j < num_fetched_shapes; ++j) {
+					PxFilterData filter_data = shapes[j]->getSimulationFilterData();
+					PxU32 mask_index = filter_data.word1;
+					PxU32 layer = filter_data.word0;
+					if((mask_index < NUM_GROUPS && (scene_data->dirty_mask_indices & (1ull << mask_index))) ||
+						(layer < NUM_GROUPS && (scene_data->dirty_ccd_layers & (1ull << layer)))) {
+						affected_shapes[num_affected++] = shapes[j];
+					}
+				}
+				if(num_affected) {
+					scene->resetFiltering(*actor, affected_shapes, num_affected);
+				}
+			}
 		}
 	}
-	gFoundation->release();
+	scene_data->dirty_mask_indices = 0;
+	scene_data->dirty_ccd_layers = 0;
 }
 
-Px_Scene px_scene_create() {
-	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
-	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
-	sceneDesc.cpuDispatcher	= gDispatcher;
-	sceneDesc.filterShader = CollisionFilterShader;
-	sceneDesc.simulationEventCallback = new SimulationEventCallback();
-	
-	// Enable contacts between kinematic/kinematic/static actors
-	sceneDesc.kineKineFilteringMode = PxPairFilteringMode::eKEEP;
-	sceneDesc.staticKineFilteringMode = PxPairFilteringMode::eKEEP;
-
-	// Enable getActiveActors
-	sceneDesc.flags.set(PxSceneFlag::eENABLE_ACTIVE_ACTORS);
+// Identifies shapes that can be shared. Built from zeroed memory so padding compares equal.
+struct Shape_Key {
+	void* mesh;
+	void* material;
+	PxTransform local_pose;
+	PxVec3 half_extents;
+	float radius;
+	uint32_t type;
+	uint32_t shape_layer_index;
+	uint32_t mask_index;
+	uint32_t trigger;
+	uint32_t query_only;
+};
 
-	PxScene* scene = gPhysics->createScene(sceneDesc);
-	scene->userData = PxCreateControllerManager(*scene);
-	
-	PxPvdSceneClient* pvdClient = scene->getScenePvdClient();
-	if(pvdClient)
-	{
-		pvdClient->setScenePvdFlag(PxPvdSceneFlag::eTRANSMIT_CONSTRAINTS, true);
-		pvdClient->setScenePvdFlag(PxPvdSceneFlag::eTRANSMIT_CONTACTS, true);
-		pvdClient->setScenePvdFlag(PxPvdSceneFlag::eTRANSMIT_SCENEQUERIES, true);
+// Open addressing table of shared shapes. Holds one reference to every shape until cleared.
+class Shape_Cache {
+public:
+	struct Entry {
+		Shape_Key key;
+		uint64_t hash;
+		PxShape* shape;
+	};
+
+	static uint64_t hash_key(Shape_Key const& key) {
+		return hash_bytes(&key, sizeof(Shape_Key));
 	}
 
-	return (Px_Scene) scene;
-}
+	PxShape* find(Shape_Key const& key, uint64_t hash) {
+		if(!capacity) {
+			return nullptr;
+		}
+		for(uint32_t i = (uint32_t) hash & (capacity - 1); entries[i].shape; i = (i + 1) & (capacity - 1)) {
+			if(entries[i].hash == hash && memcmp(&entries[i].key, &key, sizeof(Shape_Key)) == 0) {
+				return entries[i].shape;
+			}
+		}
+		return nullptr;
+	}
 
-void px_scene_release(Px_Scene scene_handle) {
-	PxScene* scene = (PxScene*) scene_handle;
-	((PxControllerManager*) scene->userData)->release();
-	if(scene->getSimulationEventCallback()) {
-		delete scene->getSimulationEventCallback();
-		scene->setSimulationEventCallback(nullptr);
+	void insert(Shape_Key const& key, uint64_t hash, PxShape* shape) {
+		if((size + 1) * 2 > capacity) {
+			grow();
+		}
+		uint32_t i = (uint32_t) hash & (capacity - 1);
+		while(entries[i].shape) {
+			i = (i + 1) & (capacity - 1);
+		}
+		entries[i].key = key;
+		entries[i].hash = hash;
+		entries[i].shape = shape;
+		++size;
 	}
-	scene->release();
-}
 
-void px_scene_simulate(Px_Scene scene_handle, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size) {
-	PxScene* scene = (PxScene*) scene_handle;
+	void clear() {
+		for(uint32_t i = 0; i < capacity; ++i) {
+			if(entries[i].shape) {
+				entries[i].shape->release();
+			}
+		}
+		if(entries) {
+			gAllocator.deallocate(entries);
+		}
+		entries = nullptr;
+		size = 0;
+		capacity = 0;
+	}
+
+	// Read without the mutex by create_shape. Callers may create shapes from several threads at once.
+	std::atomic<bool> enabled{false};
+	std::mutex mutex;
+
+private:
+	void grow() {
+		Entry* old_entries = entries;
+		uint32_t old_capacity = capacity;
+		capacity = PxMax(capacity * 2, 64u);
+		entries = (Entry*) gAllocator.allocate(sizeof(Entry) * capacity, "Shape_Cache", __FILE__, __LINE__);
+		PxMemZero(entries, sizeof(Entry) * capacity);
+		size = 0;
+		for(uint32_t i = 0; i < old_capacity; ++i) {
+			if(old_entries[i].shape) {
+				insert(old_entries[i].key, old_entries[i].hash, old_entries[i].shape);
+			}
+		}
+		if(old_entries) {
+			gAllocator.deallocate(old_entries);
+		}
+	}
+
+	Entry* entries = nullptr;
+	uint32_t size = 0;
+	uint32_t capacity = 0;
+};
+Shape_Cache gShapeCache;
+
+#define DEFAULT_BVH34_PRIMS_PER_LEAF 4 // 15 for fast
+
+PxCookingParams make_cooking_params(Px_Cooking_Options const& options) {
+	PxCookingParams params = PxCookingParams(PxTolerancesScale());
+	if(options.midphase == eMIDPHASE_BVH33) {
+		params.midphaseDesc.setToDefault(PxMeshMidPhase::eBVH33);
+	}
+	else {
+		params.midphaseDesc.setToDefault(PxMeshMidPhase::eBVH34);
+		params.midphaseDesc.mBVH34Desc.numPrimsPerLeaf = options.bvh34_prims_per_leaf ? options.bvh34_prims_per_leaf : DEFAULT_BVH34_PRIMS_PER_LEAF;
+	}
+	if(options.weld_tolerance > 0.0f) {
+		params.meshPreprocessParams |= PxMeshPreprocessingFlag::eWELD_VERTICES;
+		params.meshWeldTolerance = options.weld_tolerance;
+	}
+	if(options.disable_mesh_cleaning) {
+		params.meshPreprocessParams |= PxMeshPreprocessingFlag::eDISABLE_CLEAN_MESH;
+	}
+	if(options.disable_active_edges_precompute) {
+		params.meshPreprocessParams |= PxMeshPreprocessingFlag::eDISABLE_ACTIVE_EDGES_PRECOMPUTE;
+	}
+	params.buildGPUData = options.gpu_compatible;
+	return params;
+}
+
+// Normalized copy of the options so padding and unused fields don't affect comparisons and hashes
+Px_Cooking_Options normalize_cooking_options(Px_Cooking_Options const& options) {
+	Px_Cooking_Options result;
+	PxMemZero(&result, sizeof(result));
+	result.midphase = options.midphase;
+	if(options.midphase != eMIDPHASE_BVH33) {
+		result.bvh34_prims_per_leaf = options.bvh34_prims_per_leaf ? options.bvh34_prims_per_leaf : DEFAULT_BVH34_PRIMS_PER_LEAF;
+	}
+	result.weld_tolerance = PxMax(options.weld_tolerance, 0.0f);
+	result.disable_mesh_cleaning = options.disable_mesh_cleaning;
+	result.disable_active_edges_precompute = options.disable_active_edges_precompute;
+	result.flip_normals = options.flip_normals;
+	result.convex_vertex_limit = options.convex_vertex_limit;
+	result.gpu_compatible = options.gpu_compatible;
+	return result;
+}
+
+// gCooking for default options, otherwise a cooking instance with the requested params for the duration of the call
+class Cooking_Instance {
+public:
+	Cooking_Instance(Px_Cooking_Options const& options) {
+		Px_Cooking_Options normalized = normalize_cooking_options(options);
+		Px_Cooking_Options defaults = normalize_cooking_options(Px_Cooking_Options{});
+		// Options only used for the mesh description don't need their own instance
+		normalized.flip_normals = defaults.flip_normals;
+		normalized.convex_vertex_limit = defaults.convex_vertex_limit;
+		owned = memcmp(&normalized, &defaults, sizeof(Px_Cooking_Options)) != 0;
+		cooking = owned ? PxCreateCooking(PX_PHYSICS_VERSION, *gFoundation, make_cooking_params(options)) : gCooking;
+	}
+
+	~Cooking_Instance() {
+		if(owned) {
+			cooking->release();
+		}
+	}
+
+	PxCooking* cooking;
+	bool owned;
+};
+
+// Hands tasks to an external job system, which runs them through px_task_run
+class Callback_Dispatcher : public PxDefaultCpuDispatcher {
+public:
+	Callback_Dispatcher(Px_Submit_Task_Callback submit_task, uint32_t worker_count, void* user_data)
+		: submit_task(submit_task)
+		, worker_count(worker_count)
+		, user_data(user_data) {
+	}
+
+	virtual void submitTask(PxBaseTask& task) override {
+		submit_task((Px_Task) &task, user_data);
+	}
+
+	virtual uint32_t getWorkerCount() const override {
+		return worker_count;
+	}
+
+	virtual void release() override {
+		delete this;
+	}
+
+	virtual void setRunProfiled(bool) override {}
+
+	virtual bool getRunProfiled() const override {
+		return false;
+	}
+
+	Px_Submit_Task_Callback submit_task;
+	uint32_t worker_count;
+	void* user_data;
+};
+
+// Records PhysX profiler zones into a ring buffer. Zones are pushed lock free from any thread,
+// the start time travels through zoneStart's return value so no per thread stack is needed.
+class Profiler : public PxProfilerCallback {
+public:
+	struct Zone {
+		char const* name; // PhysX zone names are string literals
+		uint64_t start_ns;
+		uint64_t end_ns;
+		uint32_t thread_id;
+	};
+
+	void enable(uint32_t new_capacity) {
+		disable();
+		zones = (Zone*) gAllocator.allocate(sizeof(Zone) * new_capacity, "Profiler", __FILE__, __LINE__);
+		if(!zones) {
+			return;
+		}
+		capacity = new_capacity;
+		next = 0;
+		epoch = std::chrono::steady_clock::now();
+		PxSetProfilerCallback(this);
+		gTimeEventCollection = true;
+	}
+
+	void disable() {
+		if(!zones) {
+			return;
+		}
+		PxSetProfilerCallback(nullptr);
+		gTimeEventCollection = false;
+		gAllocator.deallocate(zones);
+		zones = nullptr;
+		capacity = 0;
+	}
 
+	uint64_t now_ns() const {
+		return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	virtual void* zoneStart(const char*, bool, uint64_t) override {
+		// +1 so a zone starting at 0 isn't mistaken for a detached one
+		return (void*) (uintptr_t) (now_ns() + 1);
+	}
+
+	virtual void zoneEnd(void* profiler_data, const char* event_name, bool, uint64_t) override {
+		// Cross thread zones don't pass their start back, they are skipped
+		if(!profiler_data) {
+			return;
+		}
+		static std::atomic<uint32_t> thread_counter(0);
+		static thread_local uint32_t thread_id = thread_counter++;
+
+		Zone& zone = zones[next++ % capacity];
+		zone.name = event_name;
+		zone.start_ns = (uintptr_t) profiler_data - 1;
+		zone.end_ns = now_ns();
+		zone.thread_id = thread_id;
+	}
+
+	Zone* zones = nullptr;
+	uint32_t capacity = 0;
+	std::atomic<uint64_t> next{0};
+	std::chrono::steady_clock::time_point epoch;
+};
+
+Profiler gProfiler;
+
+#define DEFAULT_NUM_THREADS 4
+
+void px_init(Px_Allocator allocator, bool initialize_cooking, bool initialize_pvd, Px_Dispatcher_Settings dispatcher_settings) {
+	gAllocator.init(allocator);
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	if(allocator.track_allocations) {
+		gFoundation->setReportAllocationNames(true);
+	}
+
+	if(initialize_pvd) {
+		gPvd = PxCreatePvd(*gFoundation);
+		PxPvdTransport* transport = PxDefaultPvdSocketTransportCreate(PVD_HOST, 5425, 10);
+		gPvd->connect(*transport, PxPvdInstrumentationFlag::eALL);
+	}
+
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale(), false, gPvd);
+	PxInitExtensions(*gPhysics, gPvd);
+	gSerializationRegistry = PxSerialization::createSerializationRegistry(*gPhysics);
+
+	if(initialize_cooking) {
+		// Params are never changed after this so meshes can be cooked from several threads at once
+		gCooking = PxCreateCooking(PX_PHYSICS_VERSION, *gFoundation, make_cooking_params(Px_Cooking_Options{}));
+	}
+
+	gDispatcher = (PxDefaultCpuDispatcher*) px_dispatcher_create(dispatcher_settings);
+}
+
+void px_destroy() {
+	gShapeCache.clear();
+	gProfiler.disable();
+	gSerializationRegistry->release();
+	PxCloseExtensions();
+	gDispatcher->release();
+	if(gCooking) {
+		gCooking->release();
+	}
+	gPhysics->release();
+	if(gPvd)
+	{
+		PxPvdTransport* transport = gPvd->getTransport();
+		gPvd->release();
+		gPvd = nullptr;
+		if(transport) {
+			transport->release();
+		}
+	}
+	gFoundation->release();
+	gAllocator.release_pools();
+}
+
+Px_Allocation_Stats px_allocator_get_stats() {
+	Px_Allocation_Stats stats = {};
+	stats.bytes = gAllocator.bytes;
+	stats.peak_bytes = gAllocator.peak_bytes;
+	stats.count = gAllocator.count;
+	stats.total_count = gAllocator.total_count;
+	stats.frame_count = gAllocator.frame_count;
+	for(Size_Class_Pool& pool : gAllocator.pools) {
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		stats.pool_reserved_bytes += pool.reserved_bytes;
+	}
+	return stats;
+}
+
+uint32_t px_allocator_get_sites(Px_Allocation_Site* sites_out, uint32_t capacity) {
+	uint32_t num_sites = 0;
+	for(Allocation_Site const& site : gAllocator.sites) {
+		if(!site.key) {
+			continue;
+		}
+		if(num_sites < capacity) {
+			Px_Allocation_Site& site_out = sites_out[num_sites];
+			site_out.type_name = site.type_name ? site.type_name : "";
+			site_out.filename = site.filename ? site.filename : "";
+			site_out.bytes = site.bytes;
+			site_out.count = site.count;
+			site_out.total_count = site.total_count;
+		}
+		++num_sites;
+	}
+	return num_sites;
+}
+
+void px_allocator_begin_frame() {
+	gAllocator.frame_count = 0;
+}
+
+#define DEFAULT_MAX_SUBSTEPS 4
+
+void px_profiler_enable(uint32_t capacity) {
+	if(capacity) {
+		gProfiler.enable(capacity);
+	}
+	else {
+		gProfiler.disable();
+	}
+}
+
+void px_profiler_clear() {
+	gProfiler.next = 0;
+}
+
+bool px_profiler_write_chrome_trace(char const* path) {
+	FILE* file = fopen(path, "wb");
+	if(!file) {
+		return false;
+	}
+	uint64_t end = gProfiler.next;
+	uint64_t count = PxMin(end, (uint64_t) gProfiler.capacity);
+	fprintf(file, "{\"traceEvents\":[");
+	for(uint64_t i = end - count; i < end; ++i) {
+		Profiler::Zone const& zone = gProfiler.zones[i % gProfiler.capacity];
+		fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			i == end - count ? "" : ",", zone.name, zone.thread_id, zone.start_ns / 1000.0, (zone.end_ns - zone.start_ns) / 1000.0);
+	}
+	fprintf(file, "\n]}\n");
+	return fclose(file) == 0;
+}
+
+Px_Dispatcher px_dispatcher_create(Px_Dispatcher_Settings settings) {
+	uint32_t num_threads = settings.num_threads ? settings.num_threads : DEFAULT_NUM_THREADS;
+	if(settings.submit_task) {
+		return (Px_Dispatcher) new Callback_Dispatcher(settings.submit_task, num_threads, settings.user_data);
+	}
+	return (Px_Dispatcher) PxDefaultCpuDispatcherCreate(num_threads, settings.affinity_masks);
+}
+
+void px_dispatcher_release(Px_Dispatcher dispatcher_handle) {
+	PxDefaultCpuDispatcher* dispatcher = (PxDefaultCpuDispatcher*) dispatcher_handle;
+	dispatcher->release();
+}
+
+void px_task_run(Px_Task task_handle) {
+	PxBaseTask* task = (PxBaseTask*) task_handle;
+	task->run();
+	task->release();
+}
+
+Px_Scene px_scene_create(Px_Scene_Settings settings) {
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
+	sceneDesc.cpuDispatcher	= settings.dispatcher ? (PxDefaultCpuDispatcher*) settings.dispatcher : gDispatcher;
+	sceneDesc.filterShader = CollisionFilterShader;
+	uint32_t event_capacity = settings.initial_event_capacity ? settings.initial_event_capacity : DEFAULT_EVENT_CAPACITY;
+	uint32_t pose_preview_capacity = settings.pose_preview_capacity ? settings.pose_preview_capacity : DEFAULT_EVENT_CAPACITY;
+	sceneDesc.simulationEventCallback = new SimulationEventCallback(event_capacity, settings.max_event_capacity, pose_preview_capacity, settings.export_contact_points);
+
+	Scene_Data* scene_data = new Scene_Data();
+	for(int i = 0; i < NUM_GROUPS; ++i) {
+		// Collide against all groups by Default
+		scene_data->filter_shader_data.collision_masks[i] = UINT64_MAX;
+	}
+	scene_data->filter_shader_data.export_contact_points = settings.export_contact_points;
+	if(settings.enable_ccd) {
+		scene_data->filter_shader_data.ccd_layers = settings.ccd_layers ? settings.ccd_layers : UINT64_MAX;
+	}
+	scene_data->fixed_step = settings.fixed_step;
+	scene_data->max_substeps = settings.max_substeps ? settings.max_substeps : DEFAULT_MAX_SUBSTEPS;
+	sceneDesc.filterShaderData = &scene_data->filter_shader_data;
+	sceneDesc.filterShaderDataSize = sizeof(Filter_Shader_Data);
+	
+	// Enable contacts between kinematic/kinematic/static actors
+	sceneDesc.kineKineFilteringMode = PxPairFilteringMode::eKEEP;
+	sceneDesc.staticKineFilteringMode = PxPairFilteringMode::eKEEP;
+
+	// Enable getActiveActors
+	sceneDesc.flags.set(PxSceneFlag::eENABLE_ACTIVE_ACTORS);
+	if(settings.enable_stabilization) {
+		sceneDesc.flags.set(PxSceneFlag::eENABLE_STABILIZATION);
+	}
+	if(settings.enable_ccd) {
+		sceneDesc.flags.set(PxSceneFlag::eENABLE_CCD);
+	}
+
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+	scene_data->controller_manager = PxCreateControllerManager(*scene);
+	scene_data->complete_task.scene = (Px_Scene) scene;
+	scene->userData = scene_data;
+	
+	PxPvdSceneClient* pvdClient = scene->getScenePvdClient();
+	if(pvdClient)
+	{
+		pvdClient->setScenePvdFlag(PxPvdSceneFlag::eTRANSMIT_CONSTRAINTS, true);
+		pvdClient->setScenePvdFlag(PxPvdSceneFlag::eTRANSMIT_CONTACTS, true);
+		pvdClient->setScenePvdFlag(PxPvdSceneFlag::eTRANSMIT_SCENEQUERIES, true);
+	}
+
+	return (Px_Scene) scene;
+}
+
+void px_scene_release(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	if(scene_data->simulating) {
+		scene->fetchResults(true);
+	}
+	for(PxU32 i = 0; i < scene_data->controller_manager->getNbControllers(); ++i) {
+		delete get_controller_data(scene_data->controller_manager->getController(i));
+	}
+	scene_data->controller_manager->release();
+	delete scene_data;
+	scene->userData = nullptr;
+	if(scene->getSimulationEventCallback()) {
+		delete scene->getSimulationEventCallback();
+		scene->setSimulationEventCallback(nullptr);
+	}
+	scene->release();
+}
+
+void px_scene_simulate(Px_Scene scene_handle, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size) {
+	px_scene_simulate_begin(scene_handle, dt, scratch_memory_16_byte_aligned, scratch_size);
+	px_scene_simulate_end(scene_handle);
+}
+
+// Only actors that moved in the previous substep can have a previous pose that differs from their current one.
+// The rest were asleep or untouched, their current pose is used instead.
+void save_previous_poses(PxScene* scene, Scene_Data* scene_data) {
+	Event_Buffer<Previous_Pose>& previous_poses = scene_data->previous_poses;
+	previous_poses.clear();
+	PxU32 num_active = 0;
+	PxActor** active_actors = scene->getActiveActors(num_active);
+	Previous_Pose* poses = previous_poses.push(num_active);
+	if(!poses) {
+		return;
+	}
+	for(PxU32 i = 0; i < num_active; ++i) {
+		PxRigidActor* actor = (PxRigidActor*) active_actors[i];
+		poses[i].actor = actor;
+		poses[i].pose = actor->getGlobalPose();
+	}
+	std::sort(poses, poses + num_active, [](Previous_Pose const& a, Previous_Pose const& b) {
+		return a.actor < b.actor;
+	});
+}
+
+// Falls back to the current pose for actors that didn't move in the previous substep
+PxTransform get_previous_pose(Scene_Data* scene_data, PxRigidActor* actor) {
+	Event_Buffer<Previous_Pose> const& previous_poses = scene_data->previous_poses;
+	Previous_Pose const* end = previous_poses.data + previous_poses.size;
+	Previous_Pose const* it = std::lower_bound(previous_poses.data, end, actor, [](Previous_Pose const& a, PxRigidActor* b) {
+		return a.actor < b;
+	});
+	return it != end && it->actor == actor ? it->pose : actor->getGlobalPose();
+}
+
+void simulate_substep(PxScene* scene, Scene_Data* scene_data, PxBaseTask* completion_task) {
+	Scoped_Timer timer(scene_data->simulate_ms);
+	((SimulationEventCallback*) scene->getSimulationEventCallback())->pose_previews.clear();
+	if(scene_data->keep_previous_poses && scene_data->remaining_substeps == 0) {
+		save_previous_poses(scene, scene_data);
+	}
+	scene->simulate(scene_data->step_dt, completion_task, scene_data->scratch_memory, scene_data->scratch_size);
+}
+
+// Fetches the running substep and kicks off the next one if any is due. Returns false once the step is done.
+bool advance_substep(PxScene* scene, Scene_Data* scene_data) {
+	{
+		Scoped_Timer timer(scene_data->fetch_results_ms);
+		scene->fetchResults(true);
+	}
+	if(scene_data->remaining_substeps == 0) {
+		scene_data->simulating = false;
+		return false;
+	}
+	--scene_data->remaining_substeps;
+	simulate_substep(scene, scene_data, nullptr);
+	return true;
+}
+
+void px_scene_simulate_begin(Px_Scene scene_handle, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	assert(!scene_data->simulating);
+
+	scene_data->simulate_ms = 0.0f;
+	scene_data->fetch_results_ms = 0.0f;
+	scene_data->num_substeps = 0;
+	scene_data->last_controller_move_ms = scene_data->controller_move_ms;
+	scene_data->controller_move_ms = 0.0f;
+
+	uint32_t num_steps = 1;
+	scene_data->step_dt = dt;
+	if(scene_data->fixed_step > 0.0f) {
+		scene_data->accumulator += dt;
+		num_steps = (uint32_t) (scene_data->accumulator / scene_data->fixed_step);
+		if(num_steps > scene_data->max_substeps) {
+			// Drop the time we can't catch up on instead of falling further behind every frame
+			num_steps = scene_data->max_substeps;
+			scene_data->accumulator = fmodf(scene_data->accumulator, scene_data->fixed_step);
+		}
+		else {
+			scene_data->accumulator -= num_steps * scene_data->fixed_step;
+		}
+		scene_data->step_dt = scene_data->fixed_step;
+		scene_data->interpolation_alpha = PxClamp(scene_data->accumulator / scene_data->fixed_step, 0.0f, 1.0f);
+	}
+	if(num_steps == 0) {
+		return;
+	}
+
+	// First step runs asynchronously, the rest are run from px_scene_simulate_end
+	scene_data->remaining_substeps = num_steps - 1;
+	scene_data->num_substeps = num_steps;
+	scene_data->scratch_memory = scratch_memory_16_byte_aligned;
+	scene_data->scratch_size = scratch_size;
+
+	apply_collision_masks(scene, scene_data);
+
+	PxBaseTask* completion_task = nullptr;
+	if(scene_data->complete_task.callback) {
+		scene_data->complete_task.setContinuation(*scene->getTaskManager(), nullptr);
+		completion_task = &scene_data->complete_task;
+	}
+
+	simulate_substep(scene, scene_data, completion_task);
+	scene_data->simulating = true;
+
+	if(completion_task) {
+		// Scene holds its own reference until the step is done
+		completion_task->removeReference();
+	}
+}
+
+bool px_scene_simulate_poll(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	return !scene_data->simulating || scene->checkResults(false);
+}
+
+void px_scene_simulate_end(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+
+	// Events are delivered from fetchResults, so the previous step's contacts/triggers
+	// stay readable while the simulation is running. Also cleared when no step was due.
 	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
-	callback->numTouch = 0;
-	callback->numTrigger = 0;
+	callback->clear();
 
-	scene->simulate(dt, nullptr, scratch_memory_16_byte_aligned, scratch_size);
-	scene->fetchResults(true);
+	if(!scene_data->simulating) {
+		return;
+	}
+	while(advance_substep(scene, scene_data)) {
+	}
+}
+
+float px_scene_get_interpolation_alpha(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	return get_scene_data(scene)->interpolation_alpha;
+}
+
+#define SCRATCH_BLOCK_ALIGNMENT (16 * 1024)
+
+void px_scenes_simulate(Px_Scene const* scene_handles, uint32_t count, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size) {
+	// PhysX wants scratch blocks in multiples of 16K
+	size_t scratch_block_size = count ? (scratch_size / count) & ~(size_t) (SCRATCH_BLOCK_ALIGNMENT - 1) : 0;
+	uint8_t* scratch = scratch_block_size ? (uint8_t*) scratch_memory_16_byte_aligned : nullptr;
+
+	// Kick all scenes before waiting on any of them so they overlap on the dispatchers
+	for(uint32_t i = 0; i < count; ++i) {
+		px_scene_simulate_begin(scene_handles[i], dt, scratch ? scratch + i * scratch_block_size : nullptr, scratch_block_size);
+	}
+	for(uint32_t i = 0; i < count; ++i) {
+		PxScene* scene = (PxScene*) scene_handles[i];
+		((SimulationEventCallback*) scene->getSimulationEventCallback())->clear();
+	}
+	// Remaining substeps advance in lockstep, so every scene's next substep is running while we wait on the others
+	for(bool stepping = true; stepping;) {
+		stepping = false;
+		for(uint32_t i = 0; i < count; ++i) {
+			PxScene* scene = (PxScene*) scene_handles[i];
+			Scene_Data* scene_data = get_scene_data(scene);
+			if(scene_data->simulating) {
+				stepping |= advance_substep(scene, scene_data);
+			}
+		}
+	}
+}
+
+void px_scene_set_simulation_complete_callback(Px_Scene scene_handle, Px_Simulation_Complete_Callback callback, void* user_data) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	assert(!scene_data->simulating);
+	scene_data->complete_task.callback = callback;
+	scene_data->complete_task.user_data = user_data;
 }
 
 void px_scene_set_gravity(Px_Scene scene_handle, Px_Vector3f32 gravity) {
@@ -376,6 +1593,28 @@ void px_scene_add_actor(Px_Scene scene_handle, Px_Actor actor_handle) {
 	scene->addActor(*actor);
 }
 
+void px_scene_add_actors(Px_Scene scene_handle, Px_Actor const* actor_handles, uint32_t count) {
+	PxScene* scene = (PxScene*) scene_handle;
+	scene->addActors((PxActor* const*) actor_handles, count);
+}
+
+Px_Pruning_Structure px_pruning_structure_create(Px_Actor const* actor_handles, uint32_t count) {
+	return (Px_Pruning_Structure) gPhysics->createPruningStructure((PxRigidActor* const*) actor_handles, count);
+}
+
+void px_pruning_structure_release(Px_Pruning_Structure pruning_structure_handle) {
+	PxPruningStructure* pruning_structure = (PxPruningStructure*) pruning_structure_handle;
+	pruning_structure->release();
+}
+
+void px_scene_add_pruning_structure(Px_Scene scene_handle, Px_Pruning_Structure pruning_structure_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxPruningStructure* pruning_structure = (PxPruningStructure*) pruning_structure_handle;
+	scene->addActors(*pruning_structure);
+	// Actors keep their scene query data, the structure itself is no longer needed
+	pruning_structure->release();
+}
+
 void px_scene_remove_actor(Px_Scene scene_handle, Px_Actor actor_handle) {
 	PxScene* scene = (PxScene*) scene_handle;
 	PxRigidActor* actor = (PxRigidActor*) actor_handle;
@@ -387,31 +1626,219 @@ Px_Actor* px_scene_get_active_actors(Px_Scene scene_handle, uint32_t* num_actors
 	return (Px_Actor*) scene->getActiveActors(*num_actors);
 }
 
+uint32_t px_scene_read_active_transforms(Px_Scene scene_handle, Px_Actor* actors_out, Px_Vector3f32* positions_out, Px_Quaternionf32* rotations_out, void** user_data_out, Px_Vector3f32* linear_velocities_out, Px_Vector3f32* angular_velocities_out, uint32_t capacity) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxU32 num_active = 0;
+	PxActor** active_actors = scene->getActiveActors(num_active);
+	PxU32 count = PxMin(num_active, capacity);
+
+	for(PxU32 i = 0; i < count; ++i) {
+		PxRigidDynamic* actor = (PxRigidDynamic*) active_actors[i];
+		if(actors_out) {
+			actors_out[i] = (Px_Actor) actor;
+		}
+		if(positions_out || rotations_out) {
+			PxTransform pose = actor->getGlobalPose();
+			if(positions_out) {
+				positions_out[i] = to_vec(pose.p);
+			}
+			if(rotations_out) {
+				rotations_out[i] = *(Px_Quaternionf32*) &pose.q;
+			}
+		}
+		if(user_data_out) {
+			user_data_out[i] = actor->userData;
+		}
+		if(linear_velocities_out) {
+			linear_velocities_out[i] = to_vec(actor->getLinearVelocity());
+		}
+		if(angular_velocities_out) {
+			angular_velocities_out[i] = to_vec(actor->getAngularVelocity());
+		}
+	}
+	return num_active;
+}
+
+// Normalized lerp along the shorter arc, close enough to slerp for the small rotations of one step
+PxQuat nlerp(PxQuat const& a, PxQuat const& b, float t) {
+	PxQuat b_near = a.dot(b) < 0.0f ? -b : b;
+	return (a * (1.0f - t) + b_near * t).getNormalized();
+}
+
+uint32_t px_scene_read_active_transforms_interpolated(Px_Scene scene_handle, Px_Actor* actors_out, Px_Vector3f32* positions_out, Px_Quaternionf32* rotations_out, Px_Vector3f32* previous_positions_out, Px_Quaternionf32* previous_rotations_out, void** user_data_out, uint32_t capacity) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	PxU32 num_active = 0;
+	PxActor** active_actors = scene->getActiveActors(num_active);
+	PxU32 count = PxMin(num_active, capacity);
+	// Poses are saved from the next step on
+	scene_data->keep_previous_poses = true;
+	float alpha = scene_data->interpolation_alpha;
+
+	for(PxU32 i = 0; i < count; ++i) {
+		PxRigidActor* actor = (PxRigidActor*) active_actors[i];
+		if(actors_out) {
+			actors_out[i] = (Px_Actor) actor;
+		}
+		PxTransform pose = actor->getGlobalPose();
+		PxTransform previous_pose = get_previous_pose(scene_data, actor);
+		if(positions_out) {
+			positions_out[i] = to_vec(previous_pose.p + (pose.p - previous_pose.p) * alpha);
+		}
+		if(rotations_out) {
+			PxQuat q = nlerp(previous_pose.q, pose.q, alpha);
+			rotations_out[i] = *(Px_Quaternionf32*) &q;
+		}
+		if(previous_positions_out) {
+			previous_positions_out[i] = to_vec(previous_pose.p);
+		}
+		if(previous_rotations_out) {
+			previous_rotations_out[i] = *(Px_Quaternionf32*) &previous_pose.q;
+		}
+		if(user_data_out) {
+			user_data_out[i] = actor->userData;
+		}
+	}
+	return num_active;
+}
+
 Px_Contact* px_scene_get_contacts(Px_Scene scene_handle, uint32_t* num_contacts) {
 	PxScene* scene = (PxScene*) scene_handle;
 	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
-	*num_contacts = (uint32_t) callback->numTouch;
-	return callback->touch;
+	*num_contacts = callback->contacts.size;
+	return callback->contacts.data;
+}
+
+Px_Contact_Pair* px_scene_get_contact_pairs(Px_Scene scene_handle, uint32_t* num_pairs) {
+	PxScene* scene = (PxScene*) scene_handle;
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+	*num_pairs = callback->contact_pairs.size;
+	return callback->contact_pairs.data;
+}
+
+Px_Contact_Point* px_scene_get_contact_points(Px_Scene scene_handle, uint32_t* num_points) {
+	PxScene* scene = (PxScene*) scene_handle;
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+	*num_points = callback->contact_points.size;
+	return callback->contact_points.data;
 }
 
 Px_Trigger* px_scene_get_triggers(Px_Scene scene_handle, uint32_t* num_triggers) {
 	PxScene* scene = (PxScene*) scene_handle;
 	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
-	*num_triggers = (uint32_t) callback->numTrigger;
-	return callback->triggers;
+	*num_triggers = callback->triggers.size;
+	return callback->triggers.data;
+}
+
+Px_Pose_Preview* px_scene_get_pose_previews(Px_Scene scene_handle, uint32_t* num_poses) {
+	PxScene* scene = (PxScene*) scene_handle;
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+	*num_poses = callback->pose_previews.size();
+	return callback->pose_previews.data;
+}
+
+Px_Actor* px_scene_get_woken_actors(Px_Scene scene_handle, uint32_t* num_actors) {
+	PxScene* scene = (PxScene*) scene_handle;
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+	*num_actors = callback->woken_actors.size;
+	return callback->woken_actors.data;
+}
+
+Px_Actor* px_scene_get_sleeping_actors(Px_Scene scene_handle, uint32_t* num_actors) {
+	PxScene* scene = (PxScene*) scene_handle;
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+	*num_actors = callback->sleeping_actors.size;
+	return callback->sleeping_actors.data;
+}
+
+Px_Scene_Stats px_scene_get_stats(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+
+	PxSimulationStatistics px_stats;
+	scene->getSimulationStatistics(px_stats);
+
+	Px_Scene_Stats stats = {};
+	stats.num_active_constraints = px_stats.nbActiveConstraints;
+	stats.num_active_dynamic_bodies = px_stats.nbActiveDynamicBodies;
+	stats.num_active_kinematic_bodies = px_stats.nbActiveKinematicBodies;
+	stats.num_static_bodies = px_stats.nbStaticBodies;
+	stats.num_dynamic_bodies = px_stats.nbDynamicBodies;
+	stats.num_kinematic_bodies = px_stats.nbKinematicBodies;
+	stats.num_axis_solver_constraints = px_stats.nbAxisSolverConstraints;
+	stats.num_partitions = px_stats.nbPartitions;
+	stats.num_broad_phase_adds = px_stats.getNbBroadPhaseAdds();
+	stats.num_broad_phase_removes = px_stats.getNbBroadPhaseRemoves();
+	stats.num_discrete_contact_pairs = px_stats.nbDiscreteContactPairsTotal;
+	stats.num_discrete_contact_pairs_with_cache_hits = px_stats.nbDiscreteContactPairsWithCacheHits;
+	stats.num_discrete_contact_pairs_with_contacts = px_stats.nbDiscreteContactPairsWithContacts;
+	stats.num_new_pairs = px_stats.nbNewPairs;
+	stats.num_lost_pairs = px_stats.nbLostPairs;
+	stats.num_new_touches = px_stats.nbNewTouches;
+	stats.num_lost_touches = px_stats.nbLostTouches;
+	stats.compressed_contact_size = px_stats.compressedContactSize;
+	stats.required_contact_constraint_memory = px_stats.requiredContactConstraintMemory;
+	stats.peak_constraint_memory = px_stats.peakConstraintMemory;
+
+	stats.num_substeps = scene_data->num_substeps;
+	stats.simulate_ms = scene_data->simulate_ms;
+	stats.fetch_results_ms = scene_data->fetch_results_ms;
+	stats.event_collection_ms = callback->collection_ms;
+	stats.controller_move_ms = scene_data->last_controller_move_ms;
+	return stats;
+}
+
+void px_scene_get_event_overflow(Px_Scene scene_handle, uint32_t* dropped_contacts, uint32_t* dropped_triggers, uint32_t* dropped_sleep_events, uint32_t* dropped_pose_previews) {
+	PxScene* scene = (PxScene*) scene_handle;
+	SimulationEventCallback* callback = (SimulationEventCallback*) scene->getSimulationEventCallback();
+	*dropped_contacts = callback->contacts.dropped + callback->contact_pairs.dropped + callback->contact_points.dropped;
+	*dropped_triggers = callback->triggers.dropped;
+	if(dropped_pose_previews) {
+		*dropped_pose_previews = callback->pose_previews.dropped;
+	}
+	if(dropped_sleep_events) {
+		*dropped_sleep_events = callback->woken_actors.dropped + callback->sleeping_actors.dropped;
+	}
 }
 
 void px_scene_set_collision_mask(Px_Scene scene_handle, uint32_t mask_index, uint64_t mask) {
-	if(mask_index >= 0 && mask_index < NUM_GROUPS) {
-		collision_masks[mask_index] = mask;
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	if(mask_index >= 0 && mask_index < NUM_GROUPS && scene_data->filter_shader_data.collision_masks[mask_index] != mask) {
+		scene_data->filter_shader_data.collision_masks[mask_index] = mask;
+		// Applied to simulation at the start of the next step
+		scene_data->dirty_mask_indices |= 1ull << mask_index;
 	}
 }
 
+void px_scene_set_ccd_layers(Px_Scene scene_handle, uint64_t layer_mask) {
+	PxScene* scene = (PxScene*) scene_handle;
+	Scene_Data* scene_data = get_scene_data(scene);
+	// Applied to simulation at the start of the next step
+	scene_data->dirty_ccd_layers |= scene_data->filter_shader_data.ccd_layers ^ layer_mask;
+	scene_data->filter_shader_data.ccd_layers = layer_mask;
+}
+
+// Query filter words hold the 64 bit layer mask split in low and high halves. PhysX keeps a shape when
+// any word of the query data ANDed with the shape's data is nonzero.
+PxQueryFilterData make_query_filter_data(PxScene* scene, uint32_t mask_index) {
+	uint64_t mask = get_scene_data(scene)->filter_shader_data.collision_masks[mask_index];
+	PxQueryFilterData query_filter_data;
+	query_filter_data.data.word0 = (PxU32) mask;
+	query_filter_data.data.word1 = (PxU32) (mask >> 32);
+	return query_filter_data;
+}
+
+PxFilterData make_shape_query_filter_data(uint32_t shape_layer_index) {
+	uint64_t layer_bit = 1ull << shape_layer_index;
+	return PxFilterData((PxU32) layer_bit, (PxU32) (layer_bit >> 32), 0, 0);
+}
+
 Px_Query_Hit px_scene_raycast(Px_Scene scene_handle, Px_Vector3f32 origin, Px_Vector3f32 direction, float distance, uint32_t mask_index) {
 	PxScene* scene = (PxScene*) scene_handle;
 	PxRaycastBuffer raycast_buffer;
-	PxQueryFilterData query_filter_data;
-	query_filter_data.data.word0 = collision_masks[mask_index];
+	PxQueryFilterData query_filter_data = make_query_filter_data(scene, mask_index);
 	scene->raycast(to_px(origin), to_px(direction), distance, raycast_buffer, PxHitFlags(PxHitFlag::eDEFAULT), query_filter_data);
 	Px_Query_Hit result;
 	result.valid = raycast_buffer.hasBlock;
@@ -420,6 +1847,78 @@ Px_Query_Hit px_scene_raycast(Px_Scene scene_handle, Px_Vector3f32 origin, Px_Ve
 	return result;
 }
 
+#define QUERY_BATCH_CHUNK_SIZE 64
+
+PxGeometryHolder to_geometry(Px_Query_Geometry geometry) {
+	switch(geometry.type) {
+		case eQUERY_GEOMETRY_BOX:
+			return PxGeometryHolder(PxBoxGeometry(to_px(geometry.half_extents)));
+		case eQUERY_GEOMETRY_CAPSULE:
+			return PxGeometryHolder(PxCapsuleGeometry(geometry.radius, geometry.half_height));
+		case eQUERY_GEOMETRY_SPHERE:
+		default:
+			return PxGeometryHolder(PxSphereGeometry(geometry.radius));
+	}
+}
+
+void write_query_hit(Px_Query_Batch_Hit& result, bool has_hit, PxLocationHit const& hit) {
+	if(has_hit) {
+		result.actor = (Px_Actor) hit.actor;
+		result.shape = (Px_Shape) hit.shape;
+		result.pos = to_vec(hit.position);
+		result.normal = to_vec(hit.normal);
+		result.distance = hit.distance;
+		result.face_index = hit.faceIndex;
+	}
+	else {
+		result = Px_Query_Batch_Hit{};
+	}
+}
+
+void px_scene_raycast_batch(Px_Scene scene_handle, Px_Vector3f32 const* origins, Px_Vector3f32 const* directions, float const* distances, uint32_t const* mask_indices, uint32_t count, Px_Query_Batch_Hit* hits_out) {
+	PxScene* scene = (PxScene*) scene_handle;
+	parallel_for(scene->getCpuDispatcher(), count, QUERY_BATCH_CHUNK_SIZE, [&](uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			PxRaycastBuffer raycast_buffer;
+			scene->raycast(to_px(origins[i]), to_px(directions[i]), distances[i], raycast_buffer, PxHitFlags(PxHitFlag::eDEFAULT), make_query_filter_data(scene, mask_indices[i]));
+			write_query_hit(hits_out[i], raycast_buffer.hasBlock, raycast_buffer.block);
+		}
+	});
+}
+
+void px_scene_sweep_batch(Px_Scene scene_handle, Px_Query_Geometry geometry, Px_Transform const* poses, Px_Vector3f32 const* directions, float const* distances, uint32_t const* mask_indices, uint32_t count, Px_Query_Batch_Hit* hits_out) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxGeometryHolder geometry_holder = to_geometry(geometry);
+	parallel_for(scene->getCpuDispatcher(), count, QUERY_BATCH_CHUNK_SIZE, [&](uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			PxSweepBuffer sweep_buffer;
+			scene->sweep(geometry_holder.any(), *(PxTransform const*) &poses[i], to_px(directions[i]), distances[i], sweep_buffer, PxHitFlags(PxHitFlag::eDEFAULT), make_query_filter_data(scene, mask_indices[i]));
+			write_query_hit(hits_out[i], sweep_buffer.hasBlock, sweep_buffer.block);
+		}
+	});
+}
+
+void px_scene_overlap_batch(Px_Scene scene_handle, Px_Query_Geometry geometry, Px_Transform const* poses, uint32_t const* mask_indices, uint32_t count, Px_Query_Batch_Hit* hits_out) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxGeometryHolder geometry_holder = to_geometry(geometry);
+	parallel_for(scene->getCpuDispatcher(), count, QUERY_BATCH_CHUNK_SIZE, [&](uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			PxOverlapBuffer overlap_buffer;
+			PxQueryFilterData query_filter_data = make_query_filter_data(scene, mask_indices[i]);
+			query_filter_data.flags |= PxQueryFlag::eANY_HIT;
+			scene->overlap(geometry_holder.any(), *(PxTransform const*) &poses[i], overlap_buffer, query_filter_data);
+
+			Px_Query_Batch_Hit& result = hits_out[i];
+			result = Px_Query_Batch_Hit{};
+			if(overlap_buffer.hasBlock) {
+				result.actor = (Px_Actor) overlap_buffer.block.actor;
+				result.shape = (Px_Shape) overlap_buffer.block.shape;
+				result.face_index = overlap_buffer.block.faceIndex;
+			}
+		}
+	});
+}
+
 Px_Material px_material_create(float static_friction, float dynamic_friction, float restitution) {
 	return (Px_Material) gPhysics->createMaterial(static_friction, dynamic_friction, restitution);
 }
@@ -429,118 +1928,467 @@ void px_material_release(Px_Material material_handle) {
 	material->release();
 }
 
-Px_Actor px_actor_create() {
-	return (Px_Actor) gPhysics->createRigidDynamic(PxTransform(PxZero, PxIdentity));
+// Dynamic actors report sleep/wake transitions, see px_scene_get_woken_actors
+PxRigidDynamic* create_rigid_dynamic(PxTransform const& pose) {
+	PxRigidDynamic* actor = gPhysics->createRigidDynamic(pose);
+	actor->setActorFlag(PxActorFlag::eSEND_SLEEP_NOTIFIES, true);
+	return actor;
+}
+
+Px_Actor px_actor_create() {
+	return (Px_Actor) create_rigid_dynamic(PxTransform(PxZero, PxIdentity));
+}
+
+PxShape* create_shape(Px_Shape_Description const& description, bool dynamic, bool shared = false);
+
+Px_Actor px_actor_create_static(Px_Transform transform, Px_Shape_Description const* shape_descriptions, uint32_t num_shapes) {
+	PxRigidStatic* actor = gPhysics->createRigidStatic(to_px_pose(transform));
+	for(uint32_t i = 0; i < num_shapes; ++i) {
+		PxShape* shape = create_shape(shape_descriptions[i], false);
+		actor->attachShape(*shape);
+		shape->release();
+	}
+	return (Px_Actor) actor;
+}
+
+void px_actors_create_batch(Px_Actor_Description const* descriptions, uint32_t count, Px_Actor* actors_out) {
+	for(uint32_t i = 0; i < count; ++i) {
+		Px_Actor_Description const& description = descriptions[i];
+		PxTransform pose = to_px_pose(description.transform);
+		if(description.type == eACTOR_STATIC) {
+			actors_out[i] = px_actor_create_static(*(Px_Transform*) &pose, description.shapes, description.num_shapes);
+		}
+		else {
+			PxRigidDynamic* actor = create_rigid_dynamic(pose);
+			if(description.type == eACTOR_KINEMATIC) {
+				actor->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, true);
+			}
+			for(uint32_t j = 0; j < description.num_shapes; ++j) {
+				PxShape* shape = create_shape(description.shapes[j], true);
+				actor->attachShape(*shape);
+				shape->release();
+			}
+			// Mass once for all shapes. Non-simulation shapes such as trimeshes are skipped.
+			PxRigidBodyExt::updateMassAndInertia(*actor, description.density > 0.0f ? description.density : 1.0f);
+			actors_out[i] = (Px_Actor) actor;
+		}
+		((PxRigidActor*) actors_out[i])->userData = description.user_data;
+	}
+}
+
+void px_actor_release(Px_Actor actor_handle) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	actor->release();
+}
+
+bool px_actor_is_static(Px_Actor actor_handle) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	return actor->is<PxRigidStatic>() != nullptr;
+}
+
+void* px_actor_get_user_data(Px_Actor actor_handle) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	return actor->userData;
+}
+
+void px_actor_set_user_data(Px_Actor actor_handle, void* user_data) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	actor->userData = user_data;
+}
+
+bool px_actor_is_sleeping(Px_Actor actor_handle) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	return actor ? actor->isSleeping() : true;
+}
+
+void px_actor_wake_up(Px_Actor actor_handle) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->wakeUp();
+	}
+}
+
+void px_actor_put_to_sleep(Px_Actor actor_handle) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->putToSleep();
+	}
+}
+
+void px_actor_set_sleep_threshold(Px_Actor actor_handle, float threshold) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setSleepThreshold(threshold);
+	}
+}
+
+void px_actor_set_stabilization_threshold(Px_Actor actor_handle, float threshold) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setStabilizationThreshold(threshold);
+	}
+}
+
+void px_actor_set_ccd(Px_Actor actor_handle, bool enabled) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_CCD, enabled);
+	}
+}
+
+void px_actor_set_speculative_ccd(Px_Actor actor_handle, bool enabled) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_SPECULATIVE_CCD, enabled);
+	}
+}
+
+void px_actor_set_pose_preview(Px_Actor actor_handle, bool enabled) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setRigidBodyFlag(PxRigidBodyFlag::eENABLE_POSE_INTEGRATION_PREVIEW, enabled);
+	}
+}
+
+void px_actor_set_kinematic(Px_Actor actor_handle, bool kinematic) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, kinematic);
+	}
+}
+
+Px_Transform px_actor_get_transform(Px_Actor actor_handle) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	return *(Px_Transform*) &actor->getGlobalPose();
+}
+
+void px_actor_set_transform(Px_Actor actor_handle, Px_Transform transform, bool teleport) {
+	PxRigidActor* rigid_actor = (PxRigidActor*) actor_handle;
+	PxRigidDynamic* actor = rigid_actor->is<PxRigidDynamic>();
+	if(!teleport && actor && actor->getScene() && (actor->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC))
+	{
+		actor->setKinematicTarget(*(PxTransform*) &transform);
+	}
+	else
+	{
+		rigid_actor->setGlobalPose(*(PxTransform*) &transform);
+	}
+}
+
+Px_Vector3f32 px_actor_get_velocity(Px_Actor actor_handle) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	return actor ? to_vec(actor->getLinearVelocity()) : Px_Vector3f32{0,0,0};
+}
+
+void px_actor_set_velocity(Px_Actor actor_handle, Px_Vector3f32 velocity) {
+	PxRigidDynamic* actor = ((PxRigidActor*) actor_handle)->is<PxRigidDynamic>();
+	if(actor) {
+		actor->setLinearVelocity(to_px(velocity));
+	}
+}
+
+template<typename T>
+T const& strided_element(void const* base, uint32_t stride, uint32_t index) {
+	return *(T const*) ((uint8_t const*) base + (size_t) index * (stride ? stride : sizeof(T)));
+}
+
+void px_actors_set_transforms(Px_Actor const* actor_handles, Px_Transform const* transforms, uint32_t transform_stride, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i) {
+		PxRigidActor* actor = (PxRigidActor*) actor_handles[i];
+		actor->setGlobalPose(strided_element<PxTransform>(transforms, transform_stride, i));
+	}
+}
+
+void px_actors_set_kinematic_targets(Px_Actor const* actor_handles, Px_Transform const* transforms, uint32_t transform_stride, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i) {
+		PxRigidDynamic* actor = ((PxRigidActor*) actor_handles[i])->is<PxRigidDynamic>();
+		if(actor) {
+			actor->setKinematicTarget(strided_element<PxTransform>(transforms, transform_stride, i));
+		}
+	}
+}
+
+void px_actors_set_velocities(Px_Actor const* actor_handles, Px_Vector3f32 const* velocities, uint32_t velocity_stride, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i) {
+		PxRigidDynamic* actor = ((PxRigidActor*) actor_handles[i])->is<PxRigidDynamic>();
+		if(actor) {
+			actor->setLinearVelocity(strided_element<PxVec3>(velocities, velocity_stride, i));
+		}
+	}
+}
+
+PxShape* create_shape_uncached(Px_Shape_Description const& description, bool dynamic, bool exclusive) {
+	PxMaterial* material = (PxMaterial*) description.material;
+	PxGeometryHolder geometry;
+	switch(description.type) {
+		case eSHAPE_BOX:
+			geometry = PxBoxGeometry(to_px(description.half_extents));
+			break;
+		case eSHAPE_SPHERE:
+			geometry = PxSphereGeometry(description.radius);
+			break;
+		case eSHAPE_TRIANGLE_MESH:
+			geometry = PxTriangleMeshGeometry((PxTriangleMesh*) description.triangle_mesh);
+			break;
+		case eSHAPE_CONVEX_MESH:
+			geometry = PxConvexMeshGeometry((PxConvexMesh*) description.convex_mesh);
+			break;
+	}
+	PxShape* shape = gPhysics->createShape(geometry.any(), *material, exclusive);
+	if(description.type == eSHAPE_TRIANGLE_MESH && dynamic) {
+		// Trimeshes can't be used for simulation on dynamic actors
+		shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
+	}
+	else if(description.trigger) {
+		shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
+		shape->setFlag(PxShapeFlag::eTRIGGER_SHAPE, true);
+	}
+	shape->setSimulationFilterData(PxFilterData(description.shape_layer_index, description.mask_index, 0, 0));
+	shape->setQueryFilterData(make_shape_query_filter_data(description.shape_layer_index));
+
+	shape->setLocalPose(to_px_pose(description.local_pose));
+	return shape;
+}
+
+// Returns a shape the caller owns one reference to. Identical descriptions share one shape while the cache is enabled,
+// otherwise the shape is exclusive to the actor it is attached to unless shared is set.
+PxShape* create_shape(Px_Shape_Description const& description, bool dynamic, bool shared) {
+	// The filter shader shifts by the layer and indexes the masks without checking
+	assert(description.shape_layer_index < NUM_GROUPS && description.mask_index < NUM_GROUPS);
+	if(!gShapeCache.enabled.load(std::memory_order_relaxed)) {
+		return create_shape_uncached(description, dynamic, !shared);
+	}
+
+	Shape_Key key;
+	PxMemZero(&key, sizeof(key));
+	switch(description.type) {
+		case eSHAPE_BOX:
+			key.half_extents = to_px(description.half_extents);
+			break;
+		case eSHAPE_SPHERE:
+			key.radius = description.radius;
+			break;
+		case eSHAPE_TRIANGLE_MESH:
+			key.mesh = description.triangle_mesh;
+			key.query_only = dynamic;
+			break;
+		case eSHAPE_CONVEX_MESH:
+			key.mesh = description.convex_mesh;
+			break;
+	}
+	key.material = description.material;
+	key.local_pose = to_px_pose(description.local_pose);
+	key.type = description.type;
+	key.shape_layer_index = description.shape_layer_index;
+	key.mask_index = description.mask_index;
+	key.trigger = description.trigger;
+	uint64_t hash = Shape_Cache::hash_key(key);
+
+	std::lock_guard<std::mutex> lock(gShapeCache.mutex);
+	PxShape* shape = gShapeCache.find(key, hash);
+	if(!shape) {
+		shape = create_shape_uncached(description, dynamic, false);
+		gShapeCache.insert(key, hash, shape);
+	}
+	shape->acquireReference();
+	return shape;
+}
+
+Px_Shape px_shape_create(Px_Shape_Description description, bool for_dynamic_actor) {
+	return (Px_Shape) create_shape(description, for_dynamic_actor, true);
+}
+
+void px_shape_release(Px_Shape shape_handle) {
+	PxShape* shape = (PxShape*) shape_handle;
+	shape->release();
+}
+
+void px_shape_cache_set_enabled(bool enabled) {
+	gShapeCache.enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void px_shape_cache_clear() {
+	std::lock_guard<std::mutex> lock(gShapeCache.mutex);
+	gShapeCache.clear();
+}
+
+void px_actor_attach_shape(Px_Actor actor_handle, Px_Shape shape_handle) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	PxShape* shape = (PxShape*) shape_handle;
+	actor->attachShape(*shape);
+	PxRigidDynamic* dynamic = actor->is<PxRigidDynamic>();
+	if(dynamic && shape->getGeometryType() != PxGeometryType::eTRIANGLEMESH) {
+		PxRigidBodyExt::updateMassAndInertia(*dynamic, 1);
+	}
+}
+
+void px_actor_add_shape(Px_Actor actor_handle, Px_Shape_Description description) {
+	PxRigidActor* actor = (PxRigidActor*) actor_handle;
+	PxRigidDynamic* dynamic = actor->is<PxRigidDynamic>();
+	PxShape* shape = create_shape(description, dynamic != nullptr);
+	actor->attachShape(*shape);
+	shape->release();
+	// Note - no mass/inertia update for trimeshes, they can't be used for simulation
+	if(dynamic && description.type != eSHAPE_TRIANGLE_MESH) {
+		PxRigidBodyExt::updateMassAndInertia(*dynamic, 1);
+	}
+}
+
+void px_actor_add_shape_box(Px_Actor actor_handle, Px_Vector3f32 half_extents, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index, bool trigger) {
+	Px_Shape_Description description = {};
+	description.type = eSHAPE_BOX;
+	description.half_extents = half_extents;
+	description.material = material_handle;
+	description.shape_layer_index = shape_layer_index;
+	description.mask_index = mask_index;
+	description.trigger = trigger;
+	px_actor_add_shape(actor_handle, description);
 }
 
-void px_actor_release(Px_Actor actor_handle) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	actor->release();
+void px_actor_add_shape_sphere(Px_Actor actor_handle, float radius, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index, bool trigger) {
+	Px_Shape_Description description = {};
+	description.type = eSHAPE_SPHERE;
+	description.radius = radius;
+	description.material = material_handle;
+	description.shape_layer_index = shape_layer_index;
+	description.mask_index = mask_index;
+	description.trigger = trigger;
+	px_actor_add_shape(actor_handle, description);
 }
 
-void* px_actor_get_user_data(Px_Actor actor_handle) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	return actor->userData;
+void px_actor_add_shape_triangle_mesh(Px_Actor actor_handle, Px_Triangle_Mesh triangle_mesh_handle, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index) {
+	Px_Shape_Description description = {};
+	description.type = eSHAPE_TRIANGLE_MESH;
+	description.triangle_mesh = triangle_mesh_handle;
+	description.material = material_handle;
+	description.shape_layer_index = shape_layer_index;
+	description.mask_index = mask_index;
+	px_actor_add_shape(actor_handle, description);
 }
 
-void px_actor_set_user_data(Px_Actor actor_handle, void* user_data) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	actor->userData = user_data;
+void px_actor_add_shape_convex_mesh(Px_Actor actor_handle, Px_Convex_Mesh convex_mesh_handle, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index) {
+	Px_Shape_Description description = {};
+	description.type = eSHAPE_CONVEX_MESH;
+	description.convex_mesh = convex_mesh_handle;
+	description.material = material_handle;
+	description.shape_layer_index = shape_layer_index;
+	description.mask_index = mask_index;
+	px_actor_add_shape(actor_handle, description);
 }
 
-void px_actor_set_kinematic(Px_Actor actor_handle, bool kinematic) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	actor->setRigidBodyFlag(PxRigidBodyFlag::eKINEMATIC, kinematic);
-}
+char gCookingCacheDirectory[1024] = "";
 
-Px_Transform px_actor_get_transform(Px_Actor actor_handle) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	return *(Px_Transform*) &actor->getGlobalPose();
-}
+#define COOKING_CACHE_MAGIC 0x32435850 // "PXC2"
 
-void px_actor_set_transform(Px_Actor actor_handle, Px_Transform transform, bool teleport) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	if(!teleport && actor->getScene() && (actor->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC))
-	{
-		actor->setKinematicTarget(*(PxTransform*) &transform);
-	}
-	else
-	{
-		actor->setGlobalPose(*(PxTransform*) &transform);
+struct Cooking_Cache_Header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t hash;
+	uint64_t check_hash; // Independent hash of the same input, so a collision on the file name alone can't match
+	uint64_t size;
+};
+
+// Multiply-xorshift, unrelated to hash_bytes
+uint64_t hash_bytes_check(void const* data, size_t size, uint64_t hash) {
+	uint8_t const* bytes = (uint8_t const*) data;
+	for(size_t i = 0; i < size; ++i) {
+		hash = (hash + bytes[i]) * 0xff51afd7ed558ccdull;
+		hash ^= hash >> 32;
 	}
+	return hash;
 }
 
-Px_Vector3f32 px_actor_get_velocity(Px_Actor actor_handle) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	return to_vec(actor->getLinearVelocity());
-}
+struct Mesh_Hash {
+	uint64_t hash;
+	uint64_t check_hash;
+};
 
-void px_actor_set_velocity(Px_Actor actor_handle, Px_Vector3f32 velocity) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	actor->setLinearVelocity(to_px(velocity));
+void hash_mesh_bytes(Mesh_Hash& mesh_hash, void const* data, size_t size) {
+	mesh_hash.hash = hash_bytes(data, size, mesh_hash.hash);
+	mesh_hash.check_hash = hash_bytes_check(data, size, mesh_hash.check_hash);
 }
 
-void px_actor_add_shape_box(Px_Actor actor_handle, Px_Vector3f32 half_extents, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index, bool trigger) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	PxMaterial* material = (PxMaterial*) material_handle;
-	PxBoxGeometry geometry;
-	geometry.halfExtents = to_px(half_extents);
-	PxShape* shape = gPhysics->createShape(geometry, *material, false);
-	shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, !trigger);
-	shape->setFlag(PxShapeFlag::eTRIGGER_SHAPE, trigger);
-	shape->setSimulationFilterData(PxFilterData(shape_layer_index, mask_index, 0, 0));
-	shape->setQueryFilterData(PxFilterData(1 << shape_layer_index, 0, 0, 0));
-	actor->attachShape(*shape);
-	shape->release();
-	PxRigidBodyExt::updateMassAndInertia(*actor, 1);
+Mesh_Hash hash_mesh_description(Px_Mesh_Description const& mesh_description, Px_Cooking_Options const& options, bool convex) {
+	Mesh_Hash mesh_hash = { FNV_OFFSET_BASIS, 0x9e3779b97f4a7c15ull };
+	uint32_t header[4] = { PX_PHYSICS_VERSION, convex, mesh_description.num_vertices, mesh_description.num_triangles };
+	hash_mesh_bytes(mesh_hash, header, sizeof(header));
+	Px_Cooking_Options normalized_options = normalize_cooking_options(options);
+	hash_mesh_bytes(mesh_hash, &normalized_options, sizeof(normalized_options));
+	for(uint32_t i = 0; i < mesh_description.num_vertices; ++i) {
+		hash_mesh_bytes(mesh_hash, &strided_element<Px_Vector3f32>(mesh_description.vertices, mesh_description.vertex_stride, i), sizeof(Px_Vector3f32));
+	}
+	if(!convex) {
+		for(uint32_t i = 0; i < mesh_description.num_triangles; ++i) {
+			hash_mesh_bytes(mesh_hash, &strided_element<uint32_t[3]>(mesh_description.indices, mesh_description.triangle_stride, i), sizeof(uint32_t[3]));
+		}
+	}
+	return mesh_hash;
 }
 
-void px_actor_add_shape_sphere(Px_Actor actor_handle, float radius, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index, bool trigger) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	PxMaterial* material = (PxMaterial*) material_handle;
-	PxSphereGeometry geometry;
-	geometry.radius = radius;
-	PxShape* shape = gPhysics->createShape(geometry, *material, false);
-	shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, !trigger);
-	shape->setFlag(PxShapeFlag::eTRIGGER_SHAPE, trigger);
-	shape->setSimulationFilterData(PxFilterData(shape_layer_index, mask_index, 0, 0));
-	shape->setQueryFilterData(PxFilterData(1 << shape_layer_index, 0, 0, 0));
-	actor->attachShape(*shape);
-	shape->release();
-	PxRigidBodyExt::updateMassAndInertia(*actor, 1);
+void cooking_cache_path(char* path, size_t path_size, uint64_t hash, bool convex) {
+	snprintf(path, path_size, "%s/%016llx.%s", gCookingCacheDirectory, (unsigned long long) hash, convex ? "cvx" : "tri");
 }
 
-void px_actor_add_shape_triangle_mesh(Px_Actor actor_handle, Px_Triangle_Mesh triangle_mesh_handle, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	PxMaterial* material = (PxMaterial*) material_handle;
-	PxTriangleMeshGeometry geometry;
-	geometry.triangleMesh = (PxTriangleMesh*) triangle_mesh_handle;
-	PxShape* shape = gPhysics->createShape(geometry, *material, false);
-	shape->setFlag(PxShapeFlag::eSIMULATION_SHAPE, false);
-	shape->setSimulationFilterData(PxFilterData(shape_layer_index, mask_index, 0, 0));
-	shape->setQueryFilterData(PxFilterData(1 << shape_layer_index, 0, 0, 0));
-	actor->attachShape(*shape);
-	shape->release();
-	// Note - no mass/inertia update. Trimeshes can't be used for simulation
-}
+bool cooking_cache_read(Mesh_Hash const& mesh_hash, bool convex, Px_Buffer* result) {
+	char path[1100];
+	cooking_cache_path(path, sizeof(path), mesh_hash.hash, convex);
+	FILE* file = fopen(path, "rb");
+	if(!file) {
+		return false;
+	}
+	long file_size = -1;
+	if(fseek(file, 0, SEEK_END) == 0) {
+		file_size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+	}
 
-void px_actor_add_shape_convex_mesh(Px_Actor actor_handle, Px_Convex_Mesh convex_mesh_handle, Px_Material material_handle, uint32_t shape_layer_index, uint32_t mask_index) {
-	PxRigidDynamic* actor = (PxRigidDynamic*) actor_handle;
-	PxMaterial* material = (PxMaterial*) material_handle;
-	PxConvexMeshGeometry geometry;
-	geometry.convexMesh = (PxConvexMesh*) convex_mesh_handle;
-	PxShape* shape = gPhysics->createShape(geometry, *material, false);
-	shape->setSimulationFilterData(PxFilterData(shape_layer_index, mask_index, 0, 0));
-	shape->setQueryFilterData(PxFilterData(1 << shape_layer_index, 0, 0, 0));
-	actor->attachShape(*shape);
-	shape->release();
-	PxRigidBodyExt::updateMassAndInertia(*actor, 1);
+	bool valid = false;
+	Cooking_Cache_Header header;
+	if(file_size >= (long) sizeof(header) && fread(&header, sizeof(header), 1, file) == 1 &&
+		header.magic == COOKING_CACHE_MAGIC && header.version == PX_PHYSICS_VERSION &&
+		header.hash == mesh_hash.hash && header.check_hash == mesh_hash.check_hash &&
+		header.size == (uint64_t) file_size - sizeof(header) && header.size <= UINT32_MAX) {
+		PxAllocatorCallback &allocator = PxGetFoundation().getAllocatorCallback();
+		void* data = allocator.allocate((size_t) header.size, "Cooking_Cache", __FILE__, __LINE__);
+		// A failed allocation counts as a miss
+		if(data && fread(data, 1, (size_t) header.size, file) == header.size) {
+			result->data = data;
+			result->size = header.size;
+			valid = true;
+		}
+		else if(data) {
+			allocator.deallocate(data);
+		}
+	}
+	fclose(file);
+	return valid;
 }
 
-Px_Buffer px_cook_triangle_mesh(Px_Mesh_Description mesh_description)
-{
-	uint32_t numTrisPerLeaf = 4; // 15 for fast
+void cooking_cache_write(Mesh_Hash const& mesh_hash, bool convex, Px_Buffer buffer) {
+	char path[1100];
+	char temp_path[1120];
+	cooking_cache_path(path, sizeof(path), mesh_hash.hash, convex);
+	// Written under a temporary name so concurrent readers never see a partial file
+	snprintf(temp_path, sizeof(temp_path), "%s.%p.tmp", path, buffer.data);
+	FILE* file = fopen(temp_path, "wb");
+	if(!file) {
+		return;
+	}
+
+	Cooking_Cache_Header header;
+	header.magic = COOKING_CACHE_MAGIC;
+	header.version = PX_PHYSICS_VERSION;
+	header.hash = mesh_hash.hash;
+	header.check_hash = mesh_hash.check_hash;
+	header.size = buffer.size;
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(buffer.data, 1, buffer.size, file) == buffer.size;
+	fclose(file);
+	if(!written || rename(temp_path, path) != 0) {
+		remove(temp_path);
+	}
+}
 
+PxTriangleMeshDesc make_triangle_mesh_desc(Px_Mesh_Description const& mesh_description, Px_Cooking_Options const& options) {
 	PxTriangleMeshDesc meshDesc;
 	meshDesc.points.count = mesh_description.num_vertices;
 	meshDesc.points.data = mesh_description.vertices;
@@ -548,41 +2396,131 @@ Px_Buffer px_cook_triangle_mesh(Px_Mesh_Description mesh_description)
 	meshDesc.triangles.count = mesh_description.num_triangles;
 	meshDesc.triangles.data = mesh_description.indices;
 	meshDesc.triangles.stride = mesh_description.triangle_stride;
-	
-	// TODO: option
-	// meshDesc.flags.set(PxMeshFlag::eFLIPNORMALS);
+	if(options.flip_normals) {
+		meshDesc.flags.set(PxMeshFlag::eFLIPNORMALS);
+	}
+	return meshDesc;
+}
+
+PxConvexMeshDesc make_convex_mesh_desc(Px_Mesh_Description const& mesh_description, Px_Cooking_Options const& options) {
+	PxConvexMeshDesc desc;
+	desc.points.data = mesh_description.vertices;
+	desc.points.count = mesh_description.num_vertices;
+	desc.points.stride = mesh_description.vertex_stride;
+	desc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+	if(options.convex_vertex_limit) {
+		desc.vertexLimit = PxClamp<PxU16>(options.convex_vertex_limit, 4, 255);
+	}
+	if(options.gpu_compatible) {
+		desc.flags |= PxConvexFlag::eGPU_COMPATIBLE;
+	}
+	return desc;
+}
 
-	PxCookingParams params = gCooking->getParams();
-	params.midphaseDesc.mBVH34Desc.numPrimsPerLeaf = numTrisPerLeaf;
+// Cooked meshes come out at roughly twice the input size. Reserving that up front avoids
+// most of the grow-and-copy steps in the output stream.
+PxU32 estimate_cooked_size(Px_Mesh_Description const& mesh_description) {
+	return 2 * (mesh_description.num_vertices * sizeof(PxVec3) + mesh_description.num_triangles * 3 * sizeof(PxU32)) + 4096;
+}
 
-	gCooking->setParams(params);
+Px_Buffer cook_triangle_mesh(PxCooking const& cooking, Px_Mesh_Description const& mesh_description, Px_Cooking_Options const& options)
+{
+	Px_Buffer result = {};
+	Mesh_Hash hash = {};
+	if(gCookingCacheDirectory[0]) {
+		hash = hash_mesh_description(mesh_description, options, false);
+		if(cooking_cache_read(hash, false, &result)) {
+			return result;
+		}
+	}
 
-	DefaultMemoryOutputStream outBuffer;
-	gCooking->cookTriangleMesh(meshDesc, outBuffer);
+	DefaultMemoryOutputStream outBuffer(estimate_cooked_size(mesh_description));
+	if(!cooking.cookTriangleMesh(make_triangle_mesh_desc(mesh_description, options), outBuffer)) {
+		// The stream was reserved up front, so it owns a buffer even when nothing was written
+		if(outBuffer.getData()) {
+			PxGetFoundation().getAllocatorCallback().deallocate(outBuffer.getData());
+		}
+		return result;
+	}
 
-	Px_Buffer result;
 	result.data = outBuffer.getData();
 	result.size = outBuffer.getSize();
+	if(gCookingCacheDirectory[0] && result.data) {
+		cooking_cache_write(hash, false, result);
+	}
 	return result;
 }
 
-Px_Buffer px_cook_convex_mesh(Px_Mesh_Description mesh_description)
+Px_Buffer cook_convex_mesh(PxCooking const& cooking, Px_Mesh_Description const& mesh_description, Px_Cooking_Options const& options)
 {
-	PxConvexMeshDesc desc;
-	desc.points.data = mesh_description.vertices;
-	desc.points.count = mesh_description.num_vertices;
-	desc.points.stride = mesh_description.vertex_stride;
-	desc.flags = PxConvexFlag::eCOMPUTE_CONVEX;
+	Px_Buffer result = {};
+	Mesh_Hash hash = {};
+	if(gCookingCacheDirectory[0]) {
+		hash = hash_mesh_description(mesh_description, options, true);
+		if(cooking_cache_read(hash, true, &result)) {
+			return result;
+		}
+	}
 
-	DefaultMemoryOutputStream outBuffer;
-	gCooking->cookConvexMesh(desc, outBuffer);
+	DefaultMemoryOutputStream outBuffer(estimate_cooked_size(mesh_description));
+	if(!cooking.cookConvexMesh(make_convex_mesh_desc(mesh_description, options), outBuffer)) {
+		// The stream was reserved up front, so it owns a buffer even when nothing was written
+		if(outBuffer.getData()) {
+			PxGetFoundation().getAllocatorCallback().deallocate(outBuffer.getData());
+		}
+		return result;
+	}
 
-	Px_Buffer result;
 	result.data = outBuffer.getData();
 	result.size = outBuffer.getSize();
+	if(gCookingCacheDirectory[0] && result.data) {
+		cooking_cache_write(hash, true, result);
+	}
 	return result;
 }
 
+Px_Buffer px_cook_triangle_mesh(Px_Mesh_Description mesh_description, Px_Cooking_Options options) {
+	Cooking_Instance instance(options);
+	return cook_triangle_mesh(*instance.cooking, mesh_description, options);
+}
+
+Px_Buffer px_cook_convex_mesh(Px_Mesh_Description mesh_description, Px_Cooking_Options options) {
+	Cooking_Instance instance(options);
+	return cook_convex_mesh(*instance.cooking, mesh_description, options);
+}
+
+void px_cook_triangle_meshes(Px_Mesh_Description const* mesh_descriptions, uint32_t count, Px_Cooking_Options options, Px_Buffer* buffers_out) {
+	Cooking_Instance instance(options);
+	parallel_for(gDispatcher, count, 1, [&](uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			buffers_out[i] = cook_triangle_mesh(*instance.cooking, mesh_descriptions[i], options);
+		}
+	});
+}
+
+void px_cook_convex_meshes(Px_Mesh_Description const* mesh_descriptions, uint32_t count, Px_Cooking_Options options, Px_Buffer* buffers_out) {
+	Cooking_Instance instance(options);
+	parallel_for(gDispatcher, count, 1, [&](uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			buffers_out[i] = cook_convex_mesh(*instance.cooking, mesh_descriptions[i], options);
+		}
+	});
+}
+
+Px_Triangle_Mesh px_triangle_mesh_cook(Px_Mesh_Description mesh_description, Px_Cooking_Options options) {
+	Cooking_Instance instance(options);
+	return (Px_Triangle_Mesh) instance.cooking->createTriangleMesh(make_triangle_mesh_desc(mesh_description, options), gPhysics->getPhysicsInsertionCallback());
+}
+
+Px_Convex_Mesh px_convex_mesh_cook(Px_Mesh_Description mesh_description, Px_Cooking_Options options) {
+	Cooking_Instance instance(options);
+	return (Px_Convex_Mesh) instance.cooking->createConvexMesh(make_convex_mesh_desc(mesh_description, options), gPhysics->getPhysicsInsertionCallback());
+}
+
+void px_cooking_set_cache_directory(char const* directory) {
+	snprintf(gCookingCacheDirectory, sizeof(gCookingCacheDirectory), "%s", directory ? directory : "");
+}
+
 void px_buffer_free(Px_Buffer buffer) {
 	PxAllocatorCallback &allocator = PxGetFoundation().getAllocatorCallback();
 	if(buffer.data) {
@@ -609,14 +2547,309 @@ void px_convex_mesh_release(Px_Convex_Mesh convex_mesh_handle) {
 	convex_mesh->release();
 }
 
+// Archive layout: header, num_meshes index entries, then the cooked mesh data
+#define MESH_ARCHIVE_MAGIC 0x414d5850 // "PXMA"
+
+struct Mesh_Archive_Header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_meshes;
+	uint32_t padding;
+};
+
+struct Mesh_Archive_Entry {
+	uint64_t offset; // From the start of the archive
+	uint64_t size;
+	uint32_t type;
+	uint32_t padding;
+};
+
+Px_Buffer px_mesh_archive_pack(Px_Buffer const* buffers, Px_Mesh_Type const* types, uint32_t count) {
+	size_t size = sizeof(Mesh_Archive_Header) + count * sizeof(Mesh_Archive_Entry);
+	for(uint32_t i = 0; i < count; ++i) {
+		size += buffers[i].size;
+	}
+
+	PxAllocatorCallback &allocator = PxGetFoundation().getAllocatorCallback();
+	uint8_t* data = (uint8_t*) allocator.allocate(size, "Mesh_Archive", __FILE__, __LINE__);
+	Px_Buffer result = {};
+	if(!data) {
+		return result;
+	}
+
+	Mesh_Archive_Header* header = (Mesh_Archive_Header*) data;
+	header->magic = MESH_ARCHIVE_MAGIC;
+	header->version = PX_PHYSICS_VERSION;
+	header->num_meshes = count;
+	header->padding = 0;
+
+	Mesh_Archive_Entry* entries = (Mesh_Archive_Entry*) (header + 1);
+	uint64_t offset = sizeof(Mesh_Archive_Header) + count * sizeof(Mesh_Archive_Entry);
+	for(uint32_t i = 0; i < count; ++i) {
+		entries[i].offset = offset;
+		entries[i].size = buffers[i].size;
+		entries[i].type = types[i];
+		entries[i].padding = 0;
+		memcpy(data + offset, buffers[i].data, buffers[i].size);
+		offset += buffers[i].size;
+	}
+
+	result.data = data;
+	result.size = size;
+	return result;
+}
+
+uint32_t px_mesh_archive_load(void const* archive, size_t archive_size, Px_Archive_Mesh* meshes_out, uint32_t capacity) {
+	Mesh_Archive_Header const* header = (Mesh_Archive_Header const*) archive;
+	if(archive_size < sizeof(Mesh_Archive_Header) || header->magic != MESH_ARCHIVE_MAGIC || header->version != PX_PHYSICS_VERSION ||
+		(archive_size - sizeof(Mesh_Archive_Header)) / sizeof(Mesh_Archive_Entry) < header->num_meshes) {
+		return 0;
+	}
+
+	// PhysX reads the cooked data straight out of the archive memory, no intermediate copies
+	Mesh_Archive_Entry const* entries = (Mesh_Archive_Entry const*) (header + 1);
+	uint32_t count = PxMin(header->num_meshes, capacity);
+	for(uint32_t i = 0; i < count; ++i) {
+		Mesh_Archive_Entry const& entry = entries[i];
+		Px_Archive_Mesh& mesh = meshes_out[i];
+		mesh = Px_Archive_Mesh{};
+		mesh.type = (Px_Mesh_Type) entry.type;
+		// Written so a malformed entry can't overflow past the check
+		if(entry.offset > archive_size || entry.size > archive_size - entry.offset || entry.size > UINT32_MAX) {
+			continue;
+		}
+		DefaultMemoryInputData stream((PxU8*) archive + entry.offset, (PxU32) entry.size);
+		if(entry.type == eMESH_TRIANGLE) {
+			mesh.triangle_mesh = (Px_Triangle_Mesh) gPhysics->createTriangleMesh(stream);
+		}
+		else {
+			mesh.convex_mesh = (Px_Convex_Mesh) gPhysics->createConvexMesh(stream);
+		}
+	}
+	return header->num_meshes;
+}
+
+uint32_t px_mesh_archive_load_file(char const* path, Px_Archive_Mesh* meshes_out, uint32_t capacity) {
+	// Maps the file instead of reading it so the archive is never held in memory twice
+	uint32_t result = 0;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file == INVALID_HANDLE_VALUE) {
+		return 0;
+	}
+	LARGE_INTEGER size;
+	HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	if(mapping) {
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if(data) {
+			result = px_mesh_archive_load(data, (size_t) size.QuadPart, meshes_out, capacity);
+			UnmapViewOfFile(data);
+		}
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+#else
+	int file = open(path, O_RDONLY);
+	if(file < 0) {
+		return 0;
+	}
+	struct stat file_stat;
+	if(fstat(file, &file_stat) == 0 && file_stat.st_size > 0) {
+		void* data = mmap(nullptr, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if(data != MAP_FAILED) {
+			madvise(data, (size_t) file_stat.st_size, MADV_SEQUENTIAL);
+			result = px_mesh_archive_load(data, (size_t) file_stat.st_size, meshes_out, capacity);
+			munmap(data, (size_t) file_stat.st_size);
+		}
+	}
+	close(file);
+#endif
+	return result;
+}
+
+// Rigid actors of the scene, minus the kinematic actors owned by character controllers
+PxCollection* create_actor_collection(PxScene* scene) {
+	PxControllerManager* controller_manager = get_scene_data(scene)->controller_manager;
+	PxCollection* controller_actors = PxCreateCollection();
+	for(PxU32 i = 0; i < controller_manager->getNbControllers(); ++i) {
+		controller_actors->add(*controller_manager->getController(i)->getActor());
+	}
+
+	PxActorTypeFlags types = PxActorTypeFlag::eRIGID_STATIC | PxActorTypeFlag::eRIGID_DYNAMIC;
+	PxU32 num_actors = scene->getNbActors(types);
+	PxActor** actors = (PxActor**) gAllocator.allocate(sizeof(PxActor*) * PxMax(num_actors, 1u), "Serialization", __FILE__, __LINE__);
+	scene->getActors(types, actors, num_actors);
+
+	PxCollection* collection = PxCreateCollection();
+	for(PxU32 i = 0; i < num_actors; ++i) {
+		if(!controller_actors->contains(*actors[i])) {
+			collection->add(*actors[i]);
+		}
+	}
+	gAllocator.deallocate(actors);
+	controller_actors->release();
+	return collection;
+}
+
+// Writes into a caller buffer, keeps counting past its capacity so the required size can be reported
+class Buffer_Output_Stream : public PxOutputStream {
+public:
+	Buffer_Output_Stream(void* buffer, size_t capacity)
+		: data((uint8_t*) buffer)
+		, capacity(buffer ? capacity : 0)
+		, size(0) {
+	}
+
+	virtual PxU32 write(const void* src, PxU32 count) override {
+		if(size + count <= capacity) {
+			PxMemCopy(data + size, src, count);
+		}
+		size += count;
+		return count;
+	}
+
+	uint8_t* data;
+	size_t capacity;
+	size_t size;
+};
+
+Px_Collection px_collection_create_shared(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxCollection* actors = create_actor_collection(scene);
+	PxSerialization::complete(*actors, *gSerializationRegistry);
+
+	// Exclusive shapes are stored with their actor. Shapes from px_shape_create or the shape cache are shared
+	// by every snapshot deserialized against this collection.
+	PxCollection* shared = PxCreateCollection();
+	for(PxU32 i = 0; i < actors->getNbObjects(); ++i) {
+		PxBase& object = actors->getObject(i);
+		PxShape* shape = object.is<PxShape>();
+		if(object.is<PxMaterial>() || object.is<PxTriangleMesh>() || object.is<PxConvexMesh>() || object.is<PxHeightField>() || (shape && !shape->isExclusive())) {
+			shared->add(object);
+		}
+	}
+	actors->release();
+	PxSerialization::createSerialObjectIds(*shared, PxSerialObjectId(1));
+	return (Px_Collection) shared;
+}
+
+size_t px_collection_serialize(Px_Collection collection_handle, void* buffer, size_t capacity) {
+	PxCollection* collection = (PxCollection*) collection_handle;
+	Buffer_Output_Stream stream(buffer, capacity);
+	PxSerialization::serializeCollectionToBinary(stream, *collection, *gSerializationRegistry);
+	return stream.size;
+}
+
+Px_Collection px_collection_deserialize(void* buffer_128_byte_aligned) {
+	if((uintptr_t) buffer_128_byte_aligned & (PX_SERIAL_FILE_ALIGN - 1)) {
+		return nullptr;
+	}
+	return (Px_Collection) PxSerialization::createCollectionFromBinary(buffer_128_byte_aligned, *gSerializationRegistry);
+}
+
+void px_collection_release(Px_Collection collection_handle, bool release_objects) {
+	PxCollection* collection = (PxCollection*) collection_handle;
+	if(release_objects) {
+		PxCollectionExt::releaseObjects(*collection);
+	}
+	collection->release();
+}
+
+size_t px_scene_serialize(Px_Scene scene_handle, Px_Collection shared_handle, void* buffer, size_t capacity) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxCollection* shared = (PxCollection*) shared_handle;
+	PxCollection* actors = create_actor_collection(scene);
+	PxSerialization::complete(*actors, *gSerializationRegistry, shared);
+
+	Buffer_Output_Stream stream(buffer, capacity);
+	PxSerialization::serializeCollectionToBinary(stream, *actors, *gSerializationRegistry, shared);
+	actors->release();
+	return stream.size;
+}
+
+uint32_t px_scene_deserialize(Px_Scene scene_handle, Px_Collection shared_handle, void* buffer_128_byte_aligned, Px_Actor* actors_out, uint32_t capacity) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxCollection* shared = (PxCollection*) shared_handle;
+	if((uintptr_t) buffer_128_byte_aligned & (PX_SERIAL_FILE_ALIGN - 1)) {
+		return 0;
+	}
+	PxCollection* collection = PxSerialization::createCollectionFromBinary(buffer_128_byte_aligned, *gSerializationRegistry, shared);
+	if(!collection) {
+		return 0;
+	}
+
+	uint32_t num_actors = 0;
+	for(PxU32 i = 0; i < collection->getNbObjects(); ++i) {
+		PxRigidActor* actor = collection->getObject(i).is<PxRigidActor>();
+		if(actor) {
+			if(actors_out && num_actors < capacity) {
+				actors_out[num_actors] = (Px_Actor) actor;
+			}
+			++num_actors;
+		}
+	}
+	scene->addCollection(*collection);
+	collection->release();
+	return num_actors;
+}
+
+uint32_t px_scene_save_state(Px_Scene scene_handle, Px_Actor_State* states_out, uint32_t capacity) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxU32 num_actors = scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+	PxU32 count = PxMin(num_actors, capacity);
+
+	// The actor pointers are fetched into the front of the output and expanded into states back to front,
+	// so state i only ever overwrites pointers that were already consumed
+	PxActor** actors = (PxActor**) states_out;
+	scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, actors, count);
+	for(PxU32 i = count; i-- > 0;) {
+		PxRigidDynamic* actor = (PxRigidDynamic*) actors[i];
+		Px_Actor_State& state = states_out[i];
+		state.actor = (Px_Actor) actor;
+		state.transform = *(Px_Transform*) &actor->getGlobalPose();
+		state.linear_velocity = to_vec(actor->getLinearVelocity());
+		state.angular_velocity = to_vec(actor->getAngularVelocity());
+		state.wake_counter = actor->getWakeCounter();
+		state.sleeping = actor->isSleeping();
+	}
+	return num_actors;
+}
+
+void px_actors_restore_state(Px_Actor_State const* states, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i) {
+		Px_Actor_State const& state = states[i];
+		PxRigidDynamic* actor = (PxRigidDynamic*) state.actor;
+		actor->setGlobalPose(*(PxTransform*) &state.transform, false);
+		if(actor->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC) {
+			continue;
+		}
+		if(state.sleeping) {
+			actor->putToSleep();
+		}
+		else {
+			actor->setLinearVelocity(to_px(state.linear_velocity), false);
+			actor->setAngularVelocity(to_px(state.angular_velocity), false);
+			actor->setWakeCounter(state.wake_counter);
+		}
+	}
+}
+
+#define DEFAULT_CONTROLLER_CONTACT_OFFSET 0.01f
+#define DEFAULT_CONTROLLER_STEP_OFFSET 0.05f
+#define DEFAULT_CONTROLLER_MIN_DISTANCE 0.001f
+
 Px_Controller px_controller_create(Px_Scene scene_handle, Px_Controller_Settings settings) {
+	assert(settings.shape_layer_index < NUM_GROUPS && settings.mask_index < NUM_GROUPS);
 	PxScene* scene = (PxScene*) scene_handle;
-	PxControllerManager* controller_manager = (PxControllerManager*) scene->userData;
+	PxControllerManager* controller_manager = get_scene_data(scene)->controller_manager;
 	PxCapsuleControllerDesc desc;
-	desc.position = PxExtendedVec3(0,0,0);
+	desc.position = PxExtendedVec3(settings.position.x, settings.position.y, settings.position.z);
 	desc.slopeLimit = cosf(settings.slope_limit_deg * M_PI / 180.0f);
-	desc.contactOffset = 0.01f;
-	desc.stepOffset = 0.05f;
+	desc.contactOffset = settings.contact_offset > 0.0f ? settings.contact_offset : DEFAULT_CONTROLLER_CONTACT_OFFSET;
+	desc.stepOffset = settings.step_offset > 0.0f ? settings.step_offset : DEFAULT_CONTROLLER_STEP_OFFSET;
+	if(settings.volume_growth > 0.0f) {
+		desc.volumeGrowth = PxMax(settings.volume_growth, 1.0f);
+	}
 	desc.invisibleWallHeight = 0.0f;
 	desc.maxJumpHeight = 0.0f;
 	desc.radius = settings.radius;
@@ -624,16 +2857,24 @@ Px_Controller px_controller_create(Px_Scene scene_handle, Px_Controller_Settings
 	desc.material = (PxMaterial*) settings.material;
 	desc.upDirection = to_px(settings.up);
 	PxController* controller = controller_manager->createController(desc); 
+	if(!controller) {
+		return nullptr;
+	}
+	Controller_Data* controller_data = new Controller_Data();
+	controller_data->min_distance = settings.min_distance > 0.0f ? settings.min_distance : DEFAULT_CONTROLLER_MIN_DISTANCE;
+	controller->setUserData(controller_data);
+
 	PxShape* shape = nullptr;
 	assert(controller->getActor()->getNbShapes() == 1);
 	controller->getActor()->getShapes(&shape, 1);
 	shape->setSimulationFilterData(PxFilterData(settings.shape_layer_index, settings.mask_index, 0, 13));
-	shape->setQueryFilterData(PxFilterData(1 << settings.shape_layer_index, 0, 0, 0));
+	shape->setQueryFilterData(make_shape_query_filter_data(settings.shape_layer_index));
 	return (Px_Controller) controller;
 }
 
 void px_controller_release(Px_Controller controller_handle) {
 	PxController* controller = (PxController*) controller_handle;
+	delete get_controller_data(controller);
 	controller->release();
 }
 
@@ -648,13 +2889,212 @@ Px_Vector3f32 px_controller_get_position(Px_Controller controller_handle) {
 
 void px_controller_set_position(Px_Controller controller_handle, Px_Vector3f32 position) {
 	PxController* controller = (PxController*) controller_handle;
+	controller->setPosition(PxExtendedVec3(position.x, position.y, position.z));
 }
 
-void px_controller_move(Px_Controller controller_handle, Px_Vector3f32 displacement, float dt, uint32_t mask_index) {
+Px_Vector3f32 px_controller_get_foot_position(Px_Controller controller_handle) {
 	PxController* controller = (PxController*) controller_handle;
-	PxFilterData filter_data(collision_masks[mask_index], 0, 0, 0);
+	PxExtendedVec3 const& position = controller->getFootPosition();
+	return Px_Vector3f32{(float) position.x, (float) position.y, (float) position.z};
+}
+
+void px_controller_set_foot_position(Px_Controller controller_handle, Px_Vector3f32 position) {
+	PxController* controller = (PxController*) controller_handle;
+	controller->setFootPosition(PxExtendedVec3(position.x, position.y, position.z));
+}
+
+void px_controller_set_step_offset(Px_Controller controller_handle, float step_offset) {
+	PxController* controller = (PxController*) controller_handle;
+	controller->setStepOffset(step_offset);
+}
+
+void px_controller_set_contact_offset(Px_Controller controller_handle, float contact_offset) {
+	PxController* controller = (PxController*) controller_handle;
+	controller->setContactOffset(contact_offset);
+}
+
+void px_controller_set_min_distance(Px_Controller controller_handle, float min_distance) {
+	PxController* controller = (PxController*) controller_handle;
+	get_controller_data(controller)->min_distance = min_distance;
+}
+
+void px_controller_set_obstacle_context(Px_Controller controller_handle, Px_Obstacle_Context obstacle_context) {
+	PxController* controller = (PxController*) controller_handle;
+	get_controller_data(controller)->obstacle_context = (PxObstacleContext*) obstacle_context;
+}
+
+void px_scene_set_controller_manager_settings(Px_Scene scene_handle, Px_Controller_Manager_Settings settings) {
+	PxScene* scene = (PxScene*) scene_handle;
+	PxControllerManager* controller_manager = get_scene_data(scene)->controller_manager;
+	controller_manager->setTessellation(settings.tessellation, settings.max_edge_length);
+	controller_manager->setOverlapRecoveryModule(!settings.disable_overlap_recovery);
+	controller_manager->setPreciseSweeps(!settings.disable_precise_sweeps);
+	controller_manager->setPreventVerticalSlidingAgainstCeiling(settings.prevent_vertical_sliding_against_ceiling);
+}
+
+Px_Obstacle_Context px_obstacle_context_create(Px_Scene scene_handle) {
+	PxScene* scene = (PxScene*) scene_handle;
+	return (Px_Obstacle_Context) get_scene_data(scene)->controller_manager->createObstacleContext();
+}
+
+void px_obstacle_context_release(Px_Obstacle_Context obstacle_context_handle) {
+	PxObstacleContext* obstacle_context = (PxObstacleContext*) obstacle_context_handle;
+	obstacle_context->release();
+}
+
+PxBoxObstacle make_box_obstacle(Px_Transform transform, Px_Vector3f32 half_extents) {
+	PxTransform pose = to_px_pose(transform);
+	PxBoxObstacle obstacle;
+	obstacle.mPos = PxExtendedVec3(pose.p.x, pose.p.y, pose.p.z);
+	obstacle.mRot = pose.q;
+	obstacle.mHalfExtents = to_px(half_extents);
+	return obstacle;
+}
+
+// Capsule axis is the local x axis, like PhysX capsule shapes
+PxCapsuleObstacle make_capsule_obstacle(Px_Transform transform, float radius, float half_height) {
+	PxTransform pose = to_px_pose(transform);
+	PxCapsuleObstacle obstacle;
+	obstacle.mPos = PxExtendedVec3(pose.p.x, pose.p.y, pose.p.z);
+	obstacle.mRot = pose.q;
+	obstacle.mRadius = radius;
+	obstacle.mHalfHeight = half_height;
+	return obstacle;
+}
+
+Px_Obstacle px_obstacle_context_add_box(Px_Obstacle_Context obstacle_context_handle, Px_Transform transform, Px_Vector3f32 half_extents) {
+	PxObstacleContext* obstacle_context = (PxObstacleContext*) obstacle_context_handle;
+	return obstacle_context->addObstacle(make_box_obstacle(transform, half_extents));
+}
+
+Px_Obstacle px_obstacle_context_add_capsule(Px_Obstacle_Context obstacle_context_handle, Px_Transform transform, float radius, float half_height) {
+	PxObstacleContext* obstacle_context = (PxObstacleContext*) obstacle_context_handle;
+	return obstacle_context->addObstacle(make_capsule_obstacle(transform, radius, half_height));
+}
+
+bool px_obstacle_context_update_box(Px_Obstacle_Context obstacle_context_handle, Px_Obstacle obstacle, Px_Transform transform, Px_Vector3f32 half_extents) {
+	PxObstacleContext* obstacle_context = (PxObstacleContext*) obstacle_context_handle;
+	return obstacle_context->updateObstacle(obstacle, make_box_obstacle(transform, half_extents));
+}
+
+bool px_obstacle_context_update_capsule(Px_Obstacle_Context obstacle_context_handle, Px_Obstacle obstacle, Px_Transform transform, float radius, float half_height) {
+	PxObstacleContext* obstacle_context = (PxObstacleContext*) obstacle_context_handle;
+	return obstacle_context->updateObstacle(obstacle, make_capsule_obstacle(transform, radius, half_height));
+}
+
+bool px_obstacle_context_remove(Px_Obstacle_Context obstacle_context_handle, Px_Obstacle obstacle) {
+	PxObstacleContext* obstacle_context = (PxObstacleContext*) obstacle_context_handle;
+	return obstacle_context->removeObstacle(obstacle);
+}
+
+PxControllerCollisionFlags move_controller(PxController* controller, PxVec3 displacement, float dt, uint32_t mask_index) {
+	Controller_Data* controller_data = get_controller_data(controller);
+	PxFilterData filter_data = make_query_filter_data(controller->getScene(), mask_index).data;
 	PxControllerFilters filters;
 	filters.mFilterData = &filter_data;
-	PxVec3 disp = to_px(displacement);
-	controller->move(disp, 0.001f, dt, filters);
+	return controller->move(displacement, controller_data->min_distance, dt, filters, controller_data->obstacle_context);
+}
+
+void px_controller_move(Px_Controller controller_handle, Px_Vector3f32 displacement, float dt, uint32_t mask_index) {
+	PxController* controller = (PxController*) controller_handle;
+	Scoped_Timer timer(get_scene_data(controller->getScene())->controller_move_ms);
+	move_controller(controller, to_px(displacement), dt, mask_index);
+}
+
+#define CONTROLLER_BATCH_CHUNK_SIZE 4
+
+struct Controller_Cell_Entry {
+	uint32_t colour; // Parity of the cell on each axis
+	uint32_t index;
+	uint64_t cell;
+};
+
+#define NUM_CELL_COLOURS 8
+
+void px_controllers_move_batch(Px_Controller const* controller_handles, Px_Vector3f32 const* displacements, uint32_t const* mask_indices, uint32_t count, float dt, float parallel_cell_size, uint8_t* collision_flags_out, Px_Vector3f32* positions_out) {
+	if(count == 0) {
+		return;
+	}
+	PxController** controllers = (PxController**) controller_handles;
+	PxScene* scene = controllers[0]->getScene();
+	Scene_Data* scene_data = get_scene_data(scene);
+	Scoped_Timer timer(scene_data->controller_move_ms);
+
+	auto move = [&](uint32_t i) {
+		PxControllerCollisionFlags flags = move_controller(controllers[i], to_px(displacements[i]), dt, mask_indices[i]);
+		if(collision_flags_out) {
+			collision_flags_out[i] = (uint8_t) flags;
+		}
+		if(positions_out) {
+			PxExtendedVec3 const& position = controllers[i]->getPosition();
+			positions_out[i] = Px_Vector3f32{(float) position.x, (float) position.y, (float) position.z};
+		}
+	};
+
+	// Cells of one colour are at least a cell apart, so they can only be moved in parallel when no controller
+	// reaches further than half a cell. Otherwise the whole batch is moved serially.
+	bool parallel = parallel_cell_size > 0.0f;
+	for(uint32_t i = 0; parallel && i < count; ++i) {
+		PxBounds3 bounds = controllers[i]->getActor()->getWorldBounds();
+		float reach = bounds.getExtents().maxElement() + controllers[i]->getContactOffset() + to_px(displacements[i]).magnitude();
+		parallel = 2.0f * reach < parallel_cell_size;
+	}
+	Controller_Cell_Entry* entries = parallel ? (Controller_Cell_Entry*) gAllocator.allocate(sizeof(Controller_Cell_Entry) * count + sizeof(uint32_t) * (count + 1), "Controller_Batch", __FILE__, __LINE__) : nullptr;
+	if(!entries) {
+		for(uint32_t i = 0; i < count; ++i) {
+			move(i);
+		}
+		return;
+	}
+
+	// Sort the controllers into cells by their start position, grouped by cell colour. Colours are moved one after
+	// another and the cells of one colour in parallel, controllers sharing a cell in their original order.
+	uint32_t* cell_starts = (uint32_t*) (entries + count);
+	float inv_cell_size = 1.0f / parallel_cell_size;
+	for(uint32_t i = 0; i < count; ++i) {
+		PxExtendedVec3 const& position = controllers[i]->getPosition();
+		int64_t cell[3] = {
+			(int64_t) floor(position.x * inv_cell_size),
+			(int64_t) floor(position.y * inv_cell_size),
+			(int64_t) floor(position.z * inv_cell_size)
+		};
+		entries[i].colour = (uint32_t) ((cell[0] & 1) | (cell[1] & 1) << 1 | (cell[2] & 1) << 2);
+		entries[i].index = i;
+		entries[i].cell = hash_bytes(cell, sizeof(cell));
+	}
+	std::sort(entries, entries + count, [](Controller_Cell_Entry const& a, Controller_Cell_Entry const& b) {
+		if(a.colour != b.colour) {
+			return a.colour < b.colour;
+		}
+		return a.cell < b.cell || (a.cell == b.cell && a.index < b.index);
+	});
+	// Colliding hashes only merge two cells of the same colour, which are then moved serially
+	uint32_t colour_starts[NUM_CELL_COLOURS + 1];
+	uint32_t num_cells = 0;
+	uint32_t next_colour = 0;
+	for(uint32_t i = 0; i < count; ++i) {
+		if(i == 0 || entries[i].colour != entries[i - 1].colour || entries[i].cell != entries[i - 1].cell) {
+			for(; next_colour <= entries[i].colour; ++next_colour) {
+				colour_starts[next_colour] = num_cells;
+			}
+			cell_starts[num_cells++] = i;
+		}
+	}
+	for(; next_colour <= NUM_CELL_COLOURS; ++next_colour) {
+		colour_starts[next_colour] = num_cells;
+	}
+	cell_starts[num_cells] = count;
+
+	// The manager's lock guards the bookkeeping shared between controllers moving on different threads
+	scene_data->controller_manager->setLockingEnabled(true);
+	for(uint32_t colour = 0; colour < NUM_CELL_COLOURS; ++colour) {
+		uint32_t first_cell = colour_starts[colour];
+		parallel_for(scene->getCpuDispatcher(), colour_starts[colour + 1] - first_cell, CONTROLLER_BATCH_CHUNK_SIZE, [&](uint32_t begin, uint32_t end) {
+			for(uint32_t i = cell_starts[first_cell + begin]; i < cell_starts[first_cell + end]; ++i) {
+				move(entries[i].index);
+			}
+		});
+	}
+	scene_data->controller_manager->setLockingEnabled(false);
+	gAllocator.deallocate(entries);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Same layout as PxVec3 and linalg.Vector3f32
@@ -30,13 +31,58 @@ typedef void* Px_Actor;
 typedef void* Px_Triangle_Mesh;
 typedef void* Px_Convex_Mesh;
 typedef void* Px_Controller;
+typedef void* Px_Shape;
+typedef void* Px_Dispatcher;
+typedef void* Px_Task;
+typedef void* Px_Pruning_Structure;
+typedef void* Px_Collection;
+typedef void* Px_Obstacle_Context;
+typedef uint32_t Px_Obstacle;
+
+// Called from a PhysX worker thread once a step started with px_scene_simulate_begin has completed.
+// Results still have to be fetched with px_scene_simulate_end. In fixed step mode this is only the
+// first substep, see px_scene_simulate_begin.
+typedef void (*Px_Simulation_Complete_Callback)(Px_Scene scene, void* user_data);
+
+// Called by PhysX to hand a task to an external job system. The job system must call px_task_run(task) exactly once,
+// on any thread.
+typedef void (*Px_Submit_Task_Callback)(Px_Task task, void* user_data);
+
+// Zero initialized settings give 4 worker threads without affinity
+typedef struct Px_Dispatcher_Settings {
+	uint32_t num_threads; // Worker threads to create, or the worker count reported to PhysX when submit_task is set. 0 for 4.
+	uint32_t* affinity_masks; // Optional, one per thread
+	Px_Submit_Task_Callback submit_task; // Optional, runs tasks on an external job system instead of creating threads
+	void* user_data;
+} Px_Dispatcher_Settings;
 
 typedef struct Px_Allocator {
 	void* (*allocate_16_byte_aligned)(struct Px_Allocator* allocator, size_t size, char const* filename, int line);
 	void (*deallocate)(struct Px_Allocator* allocator, void* ptr);
 	void* user_data;
+	bool track_allocations; // Per type/file accounting, see px_allocator_get_stats/px_allocator_get_sites
+	bool pool_small_allocations; // Serve allocations up to 1K from built-in size class pools instead of the callbacks
 } Px_Allocator;
 
+// All zero unless Px_Allocator.track_allocations was set
+typedef struct Px_Allocation_Stats {
+	uint64_t bytes;
+	uint64_t peak_bytes;
+	uint64_t count; // Live allocations
+	uint64_t total_count; // Since px_init
+	uint64_t frame_count; // Since px_allocator_begin_frame
+	uint64_t pool_reserved_bytes; // Held by the size class pools, whether in use or not
+} Px_Allocation_Stats;
+
+// Allocations grouped by PhysX's type name and source file
+typedef struct Px_Allocation_Site {
+	char const* type_name;
+	char const* filename;
+	uint64_t bytes;
+	uint64_t count;
+	uint64_t total_count;
+} Px_Allocation_Site;
+
 typedef struct Px_Buffer {
 	void* data;
 	size_t size;
@@ -51,6 +97,89 @@ typedef struct Px_Mesh_Description {
 	uint32_t triangle_stride;
 } Px_Mesh_Description;
 
+typedef enum Px_Shape_Type {
+	eSHAPE_BOX,
+	eSHAPE_SPHERE,
+	eSHAPE_TRIANGLE_MESH,
+	eSHAPE_CONVEX_MESH
+} Px_Shape_Type;
+
+// Box uses half_extents, sphere uses radius, meshes use triangle_mesh/convex_mesh.
+// A zero initialized local_pose is treated as identity.
+// Triangle meshes only take part in simulation on static actors and can't be triggers.
+typedef struct Px_Shape_Description {
+	Px_Shape_Type type;
+	Px_Vector3f32 half_extents;
+	float radius;
+	Px_Triangle_Mesh triangle_mesh;
+	Px_Convex_Mesh convex_mesh;
+	Px_Transform local_pose;
+	Px_Material material;
+	uint32_t shape_layer_index; // 0-63
+	uint32_t mask_index; // 0-63
+	bool trigger;
+} Px_Shape_Description;
+
+typedef enum Px_Actor_Type {
+	eACTOR_DYNAMIC,
+	eACTOR_KINEMATIC,
+	eACTOR_STATIC
+} Px_Actor_Type;
+
+// A zero initialized transform is treated as identity
+typedef struct Px_Actor_Description {
+	Px_Actor_Type type;
+	Px_Transform transform;
+	Px_Shape_Description const* shapes;
+	uint32_t num_shapes;
+	float density; // 0 for 1
+	void* user_data;
+} Px_Actor_Description;
+
+typedef enum Px_Midphase {
+	eMIDPHASE_BVH34,
+	eMIDPHASE_BVH33
+} Px_Midphase;
+
+// Zero initialized options give the defaults
+typedef struct Px_Cooking_Options {
+	Px_Midphase midphase;
+	uint32_t bvh34_prims_per_leaf; // 4-15, 0 for 4. Higher cooks faster and uses less memory, queries get slower.
+	float weld_tolerance; // Welds vertices closer than this when > 0
+	bool disable_mesh_cleaning; // Input must already be free of degenerate and duplicate triangles
+	bool disable_active_edges_precompute; // Faster cooking, less accurate contacts against mesh edges
+	bool flip_normals;
+	uint16_t convex_vertex_limit; // 4-255, 0 for 255
+	bool gpu_compatible; // Builds extra data for GPU simulation, off by default
+} Px_Cooking_Options;
+
+typedef enum Px_Mesh_Type {
+	eMESH_TRIANGLE,
+	eMESH_CONVEX
+} Px_Mesh_Type;
+
+// Mesh created from a mesh archive, only the handle matching type is set
+typedef struct Px_Archive_Mesh {
+	Px_Mesh_Type type;
+	Px_Triangle_Mesh triangle_mesh;
+	Px_Convex_Mesh convex_mesh;
+} Px_Archive_Mesh;
+
+// Dynamic state of an actor for rollback, sleeping actors restore with zero velocity
+typedef struct Px_Actor_State {
+	Px_Actor actor;
+	Px_Transform transform;
+	Px_Vector3f32 linear_velocity;
+	Px_Vector3f32 angular_velocity;
+	float wake_counter;
+	bool sleeping;
+} Px_Actor_State;
+
+typedef struct Px_Pose_Preview {
+	Px_Actor actor;
+	Px_Transform transform;
+} Px_Pose_Preview;
+
 typedef struct Px_Contact {
 	Px_Actor actor0;
 	Px_Actor actor1;
@@ -59,6 +188,34 @@ typedef struct Px_Contact {
 	Px_Vector3f32 impulse;
 } Px_Contact;
 
+typedef enum Px_Contact_State {
+	eCONTACT_TOUCH_FOUND,
+	eCONTACT_TOUCH_PERSISTS,
+	eCONTACT_TOUCH_LOST
+} Px_Contact_State;
+
+// Same layout as PxContactPairPoint.
+// Face indices are only meaningful for mesh shapes and resolve per-triangle materials.
+typedef struct Px_Contact_Point {
+	Px_Vector3f32 pos;
+	float separation;
+	Px_Vector3f32 normal;
+	uint32_t face_index0;
+	Px_Vector3f32 impulse;
+	uint32_t face_index1;
+} Px_Contact_Point;
+
+// Points are contact_points[first_point .. first_point + num_points]. Lost pairs have no points.
+typedef struct Px_Contact_Pair {
+	Px_Actor actor0;
+	Px_Actor actor1;
+	Px_Shape shape0;
+	Px_Shape shape1;
+	Px_Contact_State state;
+	uint32_t first_point;
+	uint32_t num_points;
+} Px_Contact_Pair;
+
 typedef enum Px_Trigger_State {
 	eNOTIFY_TOUCH_FOUND,
 	eNOTIFY_TOUCH_LOST
@@ -76,6 +233,85 @@ typedef struct Px_Query_Hit {
 	Px_Vector3f32 normal;
 } Px_Query_Hit;
 
+// Zero initialized settings give the defaults
+typedef struct Px_Scene_Settings {
+	uint32_t initial_event_capacity; // Contacts/triggers reserved up front, 0 for 256
+	uint32_t max_event_capacity; // Events past this are dropped and counted, 0 for unbounded
+	float fixed_step; // Step with this fixed dt, accumulating the dt passed to simulate. 0 to step with the passed dt.
+	uint32_t max_substeps; // Max fixed steps per simulate call, excess time is dropped. 0 for 4.
+	Px_Dispatcher dispatcher; // Optional, uses the dispatcher created by px_init when null
+	bool export_contact_points; // Report every contact point and persist/lost pairs through px_scene_get_contact_pairs instead of px_scene_get_contacts
+	uint32_t pose_preview_capacity; // Poses kept per step for px_scene_get_pose_previews, 0 for 256
+	bool enable_stabilization; // Dampens slow bodies so piles settle and fall asleep sooner, see px_actor_set_stabilization_threshold
+	bool enable_ccd; // Allows swept CCD for actors with px_actor_set_ccd. Speculative CCD works without it.
+	uint64_t ccd_layers; // Layers whose contact pairs are swept when enable_ccd is set, 0 for all. See px_scene_set_ccd_layers.
+} Px_Scene_Settings;
+
+// Hit actor is null when nothing was hit. Overlaps only fill actor, shape and face index.
+typedef struct Px_Query_Batch_Hit {
+	Px_Actor actor;
+	Px_Shape shape;
+	Px_Vector3f32 pos;
+	Px_Vector3f32 normal;
+	float distance;
+	uint32_t face_index;
+} Px_Query_Batch_Hit;
+
+typedef enum Px_Query_Geometry_Type {
+	eQUERY_GEOMETRY_SPHERE,
+	eQUERY_GEOMETRY_BOX,
+	eQUERY_GEOMETRY_CAPSULE
+} Px_Query_Geometry_Type;
+
+// Sphere uses radius, box uses half_extents, capsule uses radius and half_height along the x axis
+typedef struct Px_Query_Geometry {
+	Px_Query_Geometry_Type type;
+	Px_Vector3f32 half_extents;
+	float radius;
+	float half_height;
+} Px_Query_Geometry;
+
+// Counters come from PxSimulationStatistics of the last substep, timings are wall clock milliseconds of the
+// last px_scene_simulate_begin/end summed over its substeps
+typedef struct Px_Scene_Stats {
+	uint32_t num_active_constraints;
+	uint32_t num_active_dynamic_bodies;
+	uint32_t num_active_kinematic_bodies;
+	uint32_t num_static_bodies;
+	uint32_t num_dynamic_bodies;
+	uint32_t num_kinematic_bodies;
+	uint32_t num_axis_solver_constraints;
+	uint32_t num_partitions;
+	uint32_t num_broad_phase_adds;
+	uint32_t num_broad_phase_removes;
+	uint32_t num_discrete_contact_pairs;
+	uint32_t num_discrete_contact_pairs_with_cache_hits;
+	uint32_t num_discrete_contact_pairs_with_contacts;
+	uint32_t num_new_pairs;
+	uint32_t num_lost_pairs;
+	uint32_t num_new_touches;
+	uint32_t num_lost_touches;
+	uint32_t compressed_contact_size;
+	uint32_t required_contact_constraint_memory;
+	uint32_t peak_constraint_memory;
+
+	uint32_t num_substeps;
+	float simulate_ms;
+	// Includes event collection
+	float fetch_results_ms;
+	// Only measured while the profiler is enabled, see px_profiler_enable
+	float event_collection_ms;
+	// Controller moves between the previous and the last px_scene_simulate_begin
+	float controller_move_ms;
+} Px_Scene_Stats;
+
+// Same values as PxControllerCollisionFlag
+typedef enum Px_Controller_Collision_Flag {
+	eCONTROLLER_COLLISION_SIDES = 1 << 0,
+	eCONTROLLER_COLLISION_UP = 1 << 1,
+	eCONTROLLER_COLLISION_DOWN = 1 << 2
+} Px_Controller_Collision_Flag;
+
 typedef struct Px_Controller_Settings {
 	float slope_limit_deg;
 	float height;
@@ -84,58 +320,233 @@ typedef struct Px_Controller_Settings {
 	uint32_t shape_layer_index;
 	uint32_t mask_index;
 	Px_Material material;
+	Px_Vector3f32 position; // Center of the capsule
+	float step_offset; // 0 for 0.05
+	float contact_offset; // 0 for 0.01
+	float min_distance; // Moves shorter than this are skipped, 0 for 0.001
+	float volume_growth; // Size of the cached query volume around the controller relative to its bounds, 0 for PhysX's 1.5
 } Px_Controller_Settings;
 
+// Shared by all controllers of a scene. Zero initialized settings are PhysX's defaults.
+typedef struct Px_Controller_Manager_Settings {
+	bool tessellation; // Tessellates large triangles the controllers touch, improves collision against big triangles
+	float max_edge_length; // For tessellation
+	bool disable_overlap_recovery; // Cheaper, but controllers can stay stuck in penetration
+	bool disable_precise_sweeps; // Cheaper, less accurate sweeps
+	bool prevent_vertical_sliding_against_ceiling;
+} Px_Controller_Manager_Settings;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
-	void px_init(Px_Allocator allocator, bool initialize_cooking, bool initialize_pvd);
+	void px_init(Px_Allocator allocator, bool initialize_cooking, bool initialize_pvd, Px_Dispatcher_Settings dispatcher_settings);
 	void px_destroy();
 
-	Px_Scene px_scene_create();
+	Px_Allocation_Stats px_allocator_get_stats();
+	// Returns the number of sites, up to capacity of them are written to sites_out
+	uint32_t px_allocator_get_sites(Px_Allocation_Site* sites_out, uint32_t capacity);
+	// Resets Px_Allocation_Stats.frame_count, call once per frame to count per frame allocations
+	void px_allocator_begin_frame();
+
+	// Records PhysX profiler zones (profile and checked PhysX builds only) into a ring buffer of capacity zones,
+	// 0 disables it. Replaces PVD's profiling. Enable, clear and write between steps.
+	void px_profiler_enable(uint32_t capacity);
+	void px_profiler_clear();
+	// Writes the recorded zones as Chrome trace event JSON (chrome://tracing, Perfetto)
+	bool px_profiler_write_chrome_trace(char const* path);
+
+	// Dispatchers must outlive the scenes using them
+	Px_Dispatcher px_dispatcher_create(Px_Dispatcher_Settings settings);
+	void px_dispatcher_release(Px_Dispatcher dispatcher);
+	void px_task_run(Px_Task task);
+
+	Px_Scene px_scene_create(Px_Scene_Settings settings);
 	void px_scene_release(Px_Scene scene);
 	void px_scene_simulate(Px_Scene scene, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size);
+	// In fixed step mode only the first substep runs asynchronously, the others run blocking inside px_scene_simulate_end.
+	// Kinematic targets are reached by the end of the first substep and the actor holds still for the rest.
+	void px_scene_simulate_begin(Px_Scene scene, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size);
+	// True once the first substep is done. px_scene_simulate_end can still block on further substeps.
+	bool px_scene_simulate_poll(Px_Scene scene);
+	void px_scene_simulate_end(Px_Scene scene);
+	// Steps all scenes concurrently and waits once. Substeps run in lockstep, so scenes overlap on every substep.
+	// Scratch memory is split evenly between the scenes in blocks of a multiple of 16K.
+	void px_scenes_simulate(Px_Scene const* scenes, uint32_t count, float dt, void* scratch_memory_16_byte_aligned, size_t scratch_size);
+	// Fraction of a fixed step left in the accumulator after the last simulate call, 1 when not in fixed step mode
+	float px_scene_get_interpolation_alpha(Px_Scene scene);
+	void px_scene_set_simulation_complete_callback(Px_Scene scene, Px_Simulation_Complete_Callback callback, void* user_data);
 	void px_scene_set_gravity(Px_Scene scene, Px_Vector3f32 gravity);
 	void px_scene_add_actor(Px_Scene scene, Px_Actor actor);
+	void px_scene_add_actors(Px_Scene scene, Px_Actor const* actors, uint32_t count);
+	// Prebuilds the scene query structure for actors not yet in a scene, can be done off the simulation thread.
+	// Adding it to a scene adds all its actors and releases the structure.
+	Px_Pruning_Structure px_pruning_structure_create(Px_Actor const* actors, uint32_t count);
+	void px_pruning_structure_release(Px_Pruning_Structure pruning_structure);
+	void px_scene_add_pruning_structure(Px_Scene scene, Px_Pruning_Structure pruning_structure);
 	void px_scene_remove_actor(Px_Scene scene, Px_Actor actor);
 	Px_Actor* px_scene_get_active_actors(Px_Scene scene, uint32_t* num_actors);
+	// Fills up to capacity entries of each non-null output array in one pass over the active actors.
+	// Returns the total number of active actors, which may exceed capacity.
+	uint32_t px_scene_read_active_transforms(Px_Scene scene, Px_Actor* actors_out, Px_Vector3f32* positions_out, Px_Quaternionf32* rotations_out, void** user_data_out, Px_Vector3f32* linear_velocities_out, Px_Vector3f32* angular_velocities_out, uint32_t capacity);
+	// Like px_scene_read_active_transforms, but positions/rotations are interpolated by the scene's interpolation alpha between
+	// the previous pose (start of the last substep, also written to the optional previous arrays) and the current pose.
+	// Previous poses are recorded before each step's last substep from the first call on, until then the current pose is used.
+	// Actors that were asleep going into the last substep use their current pose as the previous one.
+	uint32_t px_scene_read_active_transforms_interpolated(Px_Scene scene, Px_Actor* actors_out, Px_Vector3f32* positions_out, Px_Quaternionf32* rotations_out, Px_Vector3f32* previous_positions_out, Px_Quaternionf32* previous_rotations_out, void** user_data_out, uint32_t capacity);
 	Px_Contact* px_scene_get_contacts(Px_Scene scene, uint32_t* num_contacts);
+	Px_Contact_Pair* px_scene_get_contact_pairs(Px_Scene scene, uint32_t* num_pairs);
+	Px_Contact_Point* px_scene_get_contact_points(Px_Scene scene, uint32_t* num_points);
 	Px_Trigger* px_scene_get_triggers(Px_Scene scene, uint32_t* num_contacts);
+	Px_Scene_Stats px_scene_get_stats(Px_Scene scene);
+	// Integrated poses of actors with pose preview enabled, readable from any thread while the step is still running.
+	// Grows as PhysX integrates bodies, entries up to the returned count are final. Reset by every simulate call,
+	// so with substeps only the running substep is visible. CCD can still move bodies after their preview.
+	Px_Pose_Preview* px_scene_get_pose_previews(Px_Scene scene, uint32_t* num_poses);
+	// Dynamic actors that woke up or fell asleep during the last step, including through API calls such as setting a velocity
+	Px_Actor* px_scene_get_woken_actors(Px_Scene scene, uint32_t* num_actors);
+	Px_Actor* px_scene_get_sleeping_actors(Px_Scene scene, uint32_t* num_actors);
+	// Number of events dropped during the last step because max_event_capacity was hit or the allocator failed.
+	// dropped_sleep_events and dropped_pose_previews are optional.
+	void px_scene_get_event_overflow(Px_Scene scene, uint32_t* dropped_contacts, uint32_t* dropped_triggers, uint32_t* dropped_sleep_events, uint32_t* dropped_pose_previews);
+	// Binary serialization of a scene's actors. Materials, meshes and shared shapes go into a separate shared collection
+	// so they are stored and loaded once for any number of scene snapshots.
+	// Serialize functions write to buffer if it is large enough and return the required size either way.
+	// Deserialize patches the buffer in place: it must be 128 byte aligned, used only once and outlive the objects created from it.
+	// Shapes from px_shape_create or the shape cache go into the shared collection, so every snapshot deserialized against it
+	// attaches the same live shapes. Other shapes are exclusive to their actor and stored with each snapshot.
+	Px_Collection px_collection_create_shared(Px_Scene scene);
+	size_t px_collection_serialize(Px_Collection collection, void* buffer, size_t capacity);
+	Px_Collection px_collection_deserialize(void* buffer_128_byte_aligned);
+	void px_collection_release(Px_Collection collection, bool release_objects);
+	size_t px_scene_serialize(Px_Scene scene, Px_Collection shared, void* buffer, size_t capacity);
+	// Adds the actors to the scene. Returns the number of actors, up to capacity of them are written to actors_out.
+	uint32_t px_scene_deserialize(Px_Scene scene, Px_Collection shared, void* buffer_128_byte_aligned, Px_Actor* actors_out, uint32_t capacity);
+	// Lightweight snapshot of all dynamic actors for rollback. Returns the number of dynamic actors, which may exceed capacity.
+	uint32_t px_scene_save_state(Px_Scene scene, Px_Actor_State* states_out, uint32_t capacity);
+	void px_actors_restore_state(Px_Actor_State const* states, uint32_t count);
+	// Per scene. Queries see the new mask immediately, simulation from the next px_scene_simulate_begin.
 	void px_scene_set_collision_mask(Px_Scene scene, uint32_t mask_index, uint64_t layer_mask);
+	// Pairs where either shape is on one of these layers get swept CCD contacts. Needs enable_ccd in the scene settings.
+	// Unlike the ccd_layers scene setting, 0 here means no layers.
+	// Applied to simulation from the next px_scene_simulate_begin.
+	void px_scene_set_ccd_layers(Px_Scene scene, uint64_t layer_mask);
 	Px_Query_Hit px_scene_raycast(Px_Scene scene, Px_Vector3f32 origin, Px_Vector3f32 direction, float distance, uint32_t mask_index);
+	// Batched queries, one hit per query written to hits_out. Spread across the dispatcher's worker threads.
+	// Directions must be normalized.
+	void px_scene_raycast_batch(Px_Scene scene, Px_Vector3f32 const* origins, Px_Vector3f32 const* directions, float const* distances, uint32_t const* mask_indices, uint32_t count, Px_Query_Batch_Hit* hits_out);
+	void px_scene_sweep_batch(Px_Scene scene, Px_Query_Geometry geometry, Px_Transform const* poses, Px_Vector3f32 const* directions, float const* distances, uint32_t const* mask_indices, uint32_t count, Px_Query_Batch_Hit* hits_out);
+	void px_scene_overlap_batch(Px_Scene scene, Px_Query_Geometry geometry, Px_Transform const* poses, uint32_t const* mask_indices, uint32_t count, Px_Query_Batch_Hit* hits_out);
 
 	Px_Material px_material_create(float static_friction, float dynamic_friction, float restitution);
 	void px_material_release(Px_Material material);
 
 	Px_Actor px_actor_create();
+	// Static actors never move and don't pay for mass, velocity or sleep state. All px_actor_* functions accept them,
+	// dynamic-only operations are ignored.
+	Px_Actor px_actor_create_static(Px_Transform transform, Px_Shape_Description const* shapes, uint32_t num_shapes);
+	// Creates actors with all their shapes, computing mass once per actor
+	void px_actors_create_batch(Px_Actor_Description const* descriptions, uint32_t count, Px_Actor* actors_out);
 	void px_actor_release(Px_Actor actor);
+	bool px_actor_is_static(Px_Actor actor);
 	void* px_actor_get_user_data(Px_Actor actor);
 	void px_actor_set_user_data(Px_Actor actor, void* user_data);
+	// Static actors always count as sleeping
+	bool px_actor_is_sleeping(Px_Actor actor);
+	void px_actor_wake_up(Px_Actor actor);
+	void px_actor_put_to_sleep(Px_Actor actor);
+	// Mass normalized kinetic energy below which the actor may fall asleep
+	void px_actor_set_sleep_threshold(Px_Actor actor, float threshold);
+	// Mass normalized kinetic energy below which the actor is dampened, when the scene has stabilization enabled
+	void px_actor_set_stabilization_threshold(Px_Actor actor, float threshold);
+	// Sweeps the actor between steps so fast bodies don't tunnel, against pairs on the scene's CCD layers. Ignored for kinematic actors.
+	void px_actor_set_ccd(Px_Actor actor, bool enabled);
+	// Cheaper than swept CCD, grows contact distance with velocity. Also works for kinematic actors.
+	void px_actor_set_speculative_ccd(Px_Actor actor, bool enabled);
+	// Reports the actor's pose through px_scene_get_pose_previews as soon as it is integrated, before the step completes
+	void px_actor_set_pose_preview(Px_Actor actor, bool enabled);
 	void px_actor_set_kinematic(Px_Actor actor, bool kinematic);
 	Px_Transform px_actor_get_transform(Px_Actor actor);
 	void px_actor_set_transform(Px_Actor actor, Px_Transform transform, bool teleport);
 	Px_Vector3f32 px_actor_get_velocity(Px_Actor actor);
 	void px_actor_set_velocity(Px_Actor actor, Px_Vector3f32 velocity);
 
+	// Batched setters. Stride is the byte distance between values, 0 for tightly packed arrays.
+	// Kinematic targets require the actors to be kinematic and in a scene.
+	void px_actors_set_transforms(Px_Actor const* actors, Px_Transform const* transforms, uint32_t transform_stride, uint32_t count);
+	void px_actors_set_kinematic_targets(Px_Actor const* actors, Px_Transform const* transforms, uint32_t transform_stride, uint32_t count);
+	void px_actors_set_velocities(Px_Actor const* actors, Px_Vector3f32 const* velocities, uint32_t velocity_stride, uint32_t count);
+
+	void px_actor_add_shape(Px_Actor actor, Px_Shape_Description shape);
+	void px_actor_attach_shape(Px_Actor actor, Px_Shape shape);
+
+	// Shapes can be attached to any number of actors. Triangle mesh shapes for dynamic actors are query only.
+	Px_Shape px_shape_create(Px_Shape_Description description, bool for_dynamic_actor);
+	void px_shape_release(Px_Shape shape);
+	// While enabled, shapes created from identical descriptions (including through px_actor_add_shape* and actor creation)
+	// are shared. The cache keeps its shapes, and their meshes and materials, alive until cleared or px_destroy.
+	void px_shape_cache_set_enabled(bool enabled);
+	void px_shape_cache_clear();
+
 	void px_actor_add_shape_box(Px_Actor actor, Px_Vector3f32 half_extents, Px_Material material, uint32_t shape_layer_index, uint32_t mask_index, bool trigger);
 	void px_actor_add_shape_sphere(Px_Actor actor, float radius, Px_Material material, uint32_t shape_layer_index, uint32_t mask_index, bool trigger);
 	void px_actor_add_shape_triangle_mesh(Px_Actor actor, Px_Triangle_Mesh triangle_mesh, Px_Material material, uint32_t shape_layer_index, uint32_t mask_index);
 	void px_actor_add_shape_convex_mesh(Px_Actor actor, Px_Convex_Mesh convex_mesh, Px_Material material, uint32_t shape_layer_index, uint32_t mask_index);
 
-	Px_Buffer px_cook_triangle_mesh(Px_Mesh_Description mesh_description);
-	Px_Buffer px_cook_convex_mesh(Px_Mesh_Description mesh_description);
+	// Returns an empty buffer when cooking fails. Failures are never written to the cooking cache.
+	Px_Buffer px_cook_triangle_mesh(Px_Mesh_Description mesh_description, Px_Cooking_Options options);
+	Px_Buffer px_cook_convex_mesh(Px_Mesh_Description mesh_description, Px_Cooking_Options options);
+	// Cooks many meshes in parallel on the dispatcher's worker threads. Cooking is thread safe, so the single mesh
+	// functions can also be called from several threads at once.
+	void px_cook_triangle_meshes(Px_Mesh_Description const* mesh_descriptions, uint32_t count, Px_Cooking_Options options, Px_Buffer* buffers_out);
+	void px_cook_convex_meshes(Px_Mesh_Description const* mesh_descriptions, uint32_t count, Px_Cooking_Options options, Px_Buffer* buffers_out);
+	// Cooked meshes are stored in the directory, keyed by a hash of their input, and loaded from there instead of cooking
+	// them again. The directory must exist. Null or empty disables the cache. Not thread safe with cooking in progress.
+	void px_cooking_set_cache_directory(char const* directory);
 	void px_buffer_free(Px_Buffer buffer);
 
 	Px_Triangle_Mesh px_triangle_mesh_create(Px_Buffer buffer);
 	void px_triangle_mesh_release(Px_Triangle_Mesh triangle_mesh);
+	// Cooks straight into a mesh without serializing to a buffer, for meshes built at runtime
+	Px_Triangle_Mesh px_triangle_mesh_cook(Px_Mesh_Description mesh_description, Px_Cooking_Options options);
 	Px_Convex_Mesh px_convex_mesh_create(Px_Buffer buffer);
 	void px_convex_mesh_release(Px_Convex_Mesh convex_mesh);
+	Px_Convex_Mesh px_convex_mesh_cook(Px_Mesh_Description mesh_description, Px_Cooking_Options options);
+	// Packs cooked mesh buffers into one archive with an index, free with px_buffer_free
+	Px_Buffer px_mesh_archive_pack(Px_Buffer const* buffers, Px_Mesh_Type const* types, uint32_t count);
+	// Creates meshes directly from an archive in memory (e.g. a mapped file) or from a file, which is memory mapped.
+	// Returns the number of meshes in the archive, 0 if it isn't valid.
+	uint32_t px_mesh_archive_load(void const* archive, size_t archive_size, Px_Archive_Mesh* meshes_out, uint32_t capacity);
+	uint32_t px_mesh_archive_load_file(char const* path, Px_Archive_Mesh* meshes_out, uint32_t capacity);
 
 	Px_Controller px_controller_create(Px_Scene scene, Px_Controller_Settings settings);
 	void px_controller_release(Px_Controller controller);
 	Px_Vector3f32 px_controller_get_position(Px_Controller controller);
+	// Teleports the controller without checking for collisions
 	void px_controller_set_position(Px_Controller controller, Px_Vector3f32 position);
+	// Bottom of the capsule, including the contact offset
+	Px_Vector3f32 px_controller_get_foot_position(Px_Controller controller);
+	void px_controller_set_foot_position(Px_Controller controller, Px_Vector3f32 position);
+	void px_controller_set_step_offset(Px_Controller controller, float step_offset);
+	void px_controller_set_contact_offset(Px_Controller controller, float contact_offset);
+	void px_controller_set_min_distance(Px_Controller controller, float min_distance);
+	// Moves of the controller collide with the context's obstacles, null to stop using one. The context must outlive its use.
+	void px_controller_set_obstacle_context(Px_Controller controller, Px_Obstacle_Context obstacle_context);
+	void px_scene_set_controller_manager_settings(Px_Scene scene, Px_Controller_Manager_Settings settings);
 	void px_controller_move(Px_Controller controller, Px_Vector3f32 displacement, float dt, uint32_t mask_index);
+	// Obstacles are only seen by controllers, much cheaper to move around than kinematic actors.
+	// Capsule obstacles are aligned to their local x axis.
+	Px_Obstacle_Context px_obstacle_context_create(Px_Scene scene);
+	void px_obstacle_context_release(Px_Obstacle_Context obstacle_context);
+	Px_Obstacle px_obstacle_context_add_box(Px_Obstacle_Context obstacle_context, Px_Transform transform, Px_Vector3f32 half_extents);
+	Px_Obstacle px_obstacle_context_add_capsule(Px_Obstacle_Context obstacle_context, Px_Transform transform, float radius, float half_height);
+	bool px_obstacle_context_update_box(Px_Obstacle_Context obstacle_context, Px_Obstacle obstacle, Px_Transform transform, Px_Vector3f32 half_extents);
+	bool px_obstacle_context_update_capsule(Px_Obstacle_Context obstacle_context, Px_Obstacle obstacle, Px_Transform transform, float radius, float half_height);
+	bool px_obstacle_context_remove(Px_Obstacle_Context obstacle_context, Px_Obstacle obstacle);
+	// Moves controllers of one scene. Collision flags (Px_Controller_Collision_Flag) and the resulting positions are written
+	// to the optional output arrays. With parallel_cell_size 0 controllers are moved in order on the calling thread, otherwise
+	// they are grouped by cells of that size and non-adjacent cells are moved in parallel on the scene's dispatcher.
+	// Falls back to moving in order when a controller's size plus displacement reaches past half a cell.
+	void px_controllers_move_batch(Px_Controller const* controllers, Px_Vector3f32 const* displacements, uint32_t const* mask_indices, uint32_t count, float dt, float parallel_cell_size, uint8_t* collision_flags_out, Px_Vector3f32* positions_out);
 
 #ifdef __cplusplus
 }